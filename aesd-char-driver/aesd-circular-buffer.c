@@ -10,6 +10,12 @@
  *              - Updated by Tanmay Mahendra Kothale on 13th March 2022
  *              - Changes for ECEN 5713 Advanced Embedded Software
  *                Development Assignment 8.             
+ *
+ *              - Updated by Tanmay Mahendra Kothale on 17th October 2026
+ *              - The depth is chosen at init and the entry array
+ *                allocated, power of two depths wrap with a mask.
+ *              - Entries carry their stream offset, positions are
+ *                found with a binary search and the size is O(1).
  * 
  * @date        2020-03-01
  * @copyright   Copyright (c) 2020
@@ -18,8 +24,13 @@
 
 #ifdef __KERNEL__
 #include <linux/string.h>
+#include <linux/errno.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
 #else
 #include <string.h>
+#include <errno.h>
+#include <stdlib.h>
 #endif
 
 #include "aesd-circular-buffer.h"
@@ -33,41 +44,42 @@
  *      in aesd_buffer. 
  * @return the struct aesd_buffer_entry structure representing the position described by char_offset, or
  * NULL if this position is not available in the buffer (not enough data is written).
+ * Binary searches the entry offsets, O(log n) in the number of entries.
  */
 struct aesd_buffer_entry *aesd_circular_buffer_find_entry_offset_for_fpos(struct aesd_circular_buffer *buffer,
 			size_t char_offset, size_t *entry_offset_byte_rtn )
 {
-    /**
-    * TODO: implement per description
-    */
-
     struct aesd_buffer_entry *entryptr;
-    
-    int idx, i=-1;
+    size_t low, high, middle, used;
 
-    while (++i < AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED)
+    if(char_offset >= buffer->total_size)
     {
-        idx = (buffer->out_offs + i) % AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED;
+        return NULL;
+    }
+    used = aesd_circular_buffer_count(buffer);
 
-        entryptr = &(buffer->entry[idx]);
-        if (entryptr == NULL)
+    //last entry starting at or before char_offset, offsets are compared
+    //relative to the oldest entry so they may wrap around
+    low = 0;
+    high = used - 1;
+    while (low < high)
+    {
+        middle = low + (high - low + 1) / 2;
+        entryptr = &(buffer->entry[aesd_circular_buffer_wrap(buffer, buffer->out_offs + middle)]);
+        if (entryptr->offset - buffer->first_offset <= char_offset)
         {
-            return NULL;
-        }
-
-        if (char_offset < entryptr->size) 
-        {   
-            //offset found
-            *entry_offset_byte_rtn = char_offset;
-            return entryptr; 
+            low = middle;
         }
         else
         {
-            char_offset -= entryptr->size;
+            high = middle - 1;
         }
     }
 
-    return NULL;
+    //offset found, empty entries before it share its offset and are skipped
+    entryptr = &(buffer->entry[aesd_circular_buffer_wrap(buffer, buffer->out_offs + low)]);
+    *entry_offset_byte_rtn = char_offset - (entryptr->offset - buffer->first_offset);
+    return entryptr;
 }
 
 /**
@@ -85,6 +97,11 @@ const char* aesd_circular_buffer_add_entry(struct aesd_circular_buffer *buffer,
 
     const char *ptr = NULL;
     
+    //a buffer without entries keeps nothing, the caller frees the new entry
+    if(buffer->depth == 0)
+    {
+        return add_entry->buffptr;
+    }
 
     // check the flag to determine if the buffer is full 
     if((buffer->full == true) && (buffer->in_offs == buffer -> out_offs))
@@ -92,14 +109,15 @@ const char* aesd_circular_buffer_add_entry(struct aesd_circular_buffer *buffer,
 
         ptr = buffer->entry[buffer->in_offs].buffptr;
 
+        //the oldest entry leaves, the stream now starts at its successor
+        buffer->total_size -= buffer->entry[buffer->in_offs].size;
+        buffer->first_offset += buffer->entry[buffer->in_offs].size;
+
         //if buffer is full, overwrite the data
         buffer->entry[buffer->in_offs] = *(add_entry);
-        buffer->in_offs = (buffer->in_offs + 1) % AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED;
-        //check if write pointer reached limit, if yes, roll back to 0
-        if(buffer->in_offs == AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED)
-        {
-            buffer->in_offs = 0;
-        }
+        buffer->entry[buffer->in_offs].offset = buffer->first_offset + buffer->total_size;
+        buffer->total_size += add_entry->size;
+        buffer->in_offs = aesd_circular_buffer_wrap(buffer, buffer->in_offs + 1);
         buffer->out_offs = buffer->in_offs; 
     }
 
@@ -108,13 +126,9 @@ const char* aesd_circular_buffer_add_entry(struct aesd_circular_buffer *buffer,
 
         //add new entry to the buffer
         buffer->entry[buffer->in_offs] = *(add_entry);
-        buffer->in_offs = (buffer->in_offs + 1) % AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED;
-
-        //check if write pointer reached limit, if yes, roll back to 0
-        if(buffer->in_offs == AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED)
-        {
-            buffer->in_offs = 0;
-        }
+        buffer->entry[buffer->in_offs].offset = buffer->first_offset + buffer->total_size;
+        buffer->total_size += add_entry->size;
+        buffer->in_offs = aesd_circular_buffer_wrap(buffer, buffer->in_offs + 1);
 
         //Check if buffer is full after writing
         if(buffer->in_offs == buffer->out_offs)
@@ -134,9 +148,65 @@ const char* aesd_circular_buffer_add_entry(struct aesd_circular_buffer *buffer,
 }
 
 /**
-* Initializes the circular buffer described by @param buffer to an empty struct
+* Initializes the circular buffer described by @param buffer to an empty struct holding
+* up to @param depth entries. The entry array is allocated here and freed by
+* aesd_circular_buffer_release(), the memory of the entries themselves stays with the caller.
+* @return 0 on success, -EINVAL for a depth of 0, -ENOMEM if the array could not be allocated
+*/
+int aesd_circular_buffer_init_depth(struct aesd_circular_buffer *buffer, size_t depth)
+{
+    memset(buffer,0,sizeof(struct aesd_circular_buffer));
+
+    if(depth == 0)
+    {
+        return -EINVAL;
+    }
+
+#ifdef __KERNEL__
+    //deep buffers need more than kmalloc() gives in one piece
+    buffer->entry = kvcalloc(depth, sizeof(struct aesd_buffer_entry), GFP_KERNEL);
+#else
+    buffer->entry = calloc(depth, sizeof(struct aesd_buffer_entry));
+#endif
+    if(buffer->entry == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    buffer->depth = depth;
+    buffer->mask = ((depth & (depth - 1)) == 0) ? depth - 1 : 0;
+    return 0;
+}
+
+/**
+* Initializes the circular buffer described by @param buffer to an empty struct of
+* AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED entries. If the entry array cannot be
+* allocated the buffer has a depth of 0 and keeps nothing.
 */
 void aesd_circular_buffer_init(struct aesd_circular_buffer *buffer)
 {
+    aesd_circular_buffer_init_depth(buffer, AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED);
+}
+
+/**
+* @return the number of bytes in all entries of @param buffer, what a read from
+* char_offset 0 returns in total. Any necessary locking must be performed by caller.
+*/
+size_t aesd_circular_buffer_size(const struct aesd_circular_buffer *buffer)
+{
+    return buffer->total_size;
+}
+
+/**
+* Frees the entry array of @param buffer, not the memory the entries point to.
+* The buffer has a depth of 0 afterwards.
+*/
+void aesd_circular_buffer_release(struct aesd_circular_buffer *buffer)
+{
+#ifdef __KERNEL__
+    kvfree(buffer->entry);
+#else
+    free(buffer->entry);
+#endif
     memset(buffer,0,sizeof(struct aesd_circular_buffer));
 }
@@ -17,6 +17,11 @@
 #include <stdio.h>
 #endif
 
+/**
+ * Default number of entries kept by the buffer. The aesdchar module takes its
+ * depth from the aesd_depth module parameter, userspace passes it to
+ * aesd_circular_buffer_init_depth(). Power of two depths wrap with a mask.
+ */
 #define AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED 10
 
 struct aesd_buffer_entry
@@ -29,27 +34,49 @@ struct aesd_buffer_entry
 	 * Number of bytes stored in buffptr
 	 */
 	size_t size;
+	/**
+	 * Position of the first byte in the stream of every byte ever added, set by
+	 * aesd_circular_buffer_add_entry(). Increases from entry to entry, so the
+	 * entries can be binary searched by position.
+	 */
+	size_t offset;
 };
 
 struct aesd_circular_buffer
 {
 	/**
-	 * An array of pointers to memory allocated for the most recent write operations
+	 * An array of depth pointers to memory allocated for the most recent write operations
+	 */
+	struct aesd_buffer_entry *entry;
+	/**
+	 * Number of entries in the entry array
 	 */
-	struct aesd_buffer_entry  entry[AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED];
+	size_t depth;
+	/**
+	 * depth - 1 when depth is a power of two, else 0 and indices wrap with %
+	 */
+	size_t mask;
 	/**
 	 * The current location in the entry structure where the next write should
 	 * be stored.
 	 */
-	uint8_t in_offs;
+	size_t in_offs;
 	/**
 	 * The first location in the entry structure to read from
 	 */
-	uint8_t out_offs;
+	size_t out_offs;
 	/**
 	 * set to true when the buffer entry structure is full
 	 */
 	bool full;
+	/**
+	 * offset of the entry at out_offs, the stream position of char_offset 0
+	 */
+	size_t first_offset;
+	/**
+	 * Number of bytes in all entries, updated as entries are added and overwritten
+	 */
+	size_t total_size;
 };
 
 extern struct aesd_buffer_entry *aesd_circular_buffer_find_entry_offset_for_fpos(struct aesd_circular_buffer *buffer,
@@ -57,16 +84,44 @@ extern struct aesd_buffer_entry *aesd_circular_buffer_find_entry_offset_for_fpos
 
 extern const char* aesd_circular_buffer_add_entry(struct aesd_circular_buffer *buffer, const struct aesd_buffer_entry *add_entry);
 
+extern int aesd_circular_buffer_init_depth(struct aesd_circular_buffer *buffer, size_t depth);
+
 extern void aesd_circular_buffer_init(struct aesd_circular_buffer *buffer);
 
+extern void aesd_circular_buffer_release(struct aesd_circular_buffer *buffer);
+
+extern size_t aesd_circular_buffer_size(const struct aesd_circular_buffer *buffer);
+
+/**
+ * @return the position in buffer->entry of index, counted from the start of the array
+ * and wrapped around its end
+ */
+static inline size_t aesd_circular_buffer_wrap(const struct aesd_circular_buffer *buffer, size_t index)
+{
+	return (buffer->mask != 0) ? (index & buffer->mask) : (index % buffer->depth);
+}
+
+/**
+ * @return the number of entries written to buffer, at most its depth
+ */
+static inline size_t aesd_circular_buffer_count(const struct aesd_circular_buffer *buffer)
+{
+	if(buffer->full)
+	{
+		return buffer->depth;
+	}
+	return (buffer->in_offs >= buffer->out_offs) ? buffer->in_offs - buffer->out_offs
+			: buffer->in_offs + buffer->depth - buffer->out_offs;
+}
+
 /**
  * Create a for loop to iterate over each member of the circular buffer.
  * Useful when you've allocated memory for circular buffer entries and need to free it
  * @param entryptr is a struct aesd_buffer_entry* to set with the current entry
  * @param buffer is the struct aesd_buffer * describing the buffer
- * @param index is a uint8_t stack allocated value used by this macro for an index
+ * @param index is a size_t stack allocated value used by this macro for an index
  * Example usage:
- * uint8_t index;
+ * size_t index;
  * struct aesd_circular_buffer buffer;
  * struct aesd_buffer_entry *entry;
  * AESD_CIRCULAR_BUFFER_FOREACH(entry,&buffer,index) {
@@ -75,7 +130,7 @@ extern void aesd_circular_buffer_init(struct aesd_circular_buffer *buffer);
  */
 #define AESD_CIRCULAR_BUFFER_FOREACH(entryptr,buffer,index) \
 	for(index=0, entryptr=&((buffer)->entry[index]); \
-			index<AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED; \
+			index<(buffer)->depth; \
 			index++, entryptr=&((buffer)->entry[index]))
 
 
@@ -0,0 +1,51 @@
+/*
+ * aesd_ioctl.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Tanmay Mahendra Kothale
+ *
+ *  @brief Definitions for the ioctls of the aesd char device, shared with
+ *  userspace
+ */
+
+#ifndef AESD_IOCTL_H
+#define AESD_IOCTL_H
+
+#ifdef __KERNEL__
+#include <linux/ioctl.h>
+#include <linux/types.h>
+#else
+#include <sys/ioctl.h>
+#include <stdint.h>
+#endif
+
+/**
+ * A position in the circular buffer given as a command and a byte within it
+ */
+struct aesd_seekto
+{
+	/**
+	 * The zero referenced command to seek to, 0 is the oldest command still in the buffer
+	 */
+	uint32_t write_cmd;
+	/**
+	 * The zero referenced byte offset within that command
+	 */
+	uint32_t write_cmd_offset;
+};
+
+#define AESD_IOC_MAGIC 0x16
+
+/**
+ * Moves the file position to the byte described by a struct aesd_seekto, so the next
+ * read starts there. Fails with EINVAL if the command or the byte within it is not in
+ * the buffer.
+ */
+#define AESDCHAR_IOCSEEKTO _IOWR(AESD_IOC_MAGIC, 1, struct aesd_seekto)
+
+/**
+ * The maximum number of the ioctls above
+ */
+#define AESDCHAR_IOC_MAXNR 1
+
+#endif /* AESD_IOCTL_H */
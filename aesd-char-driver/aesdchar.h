@@ -33,8 +33,9 @@ struct aesd_dev
 	struct cdev cdev;	  /* Char device structure		*/
 	
 	struct aesd_circular_buffer circular_buffer;
-	struct aesd_buffer_entry buffer_entry;
-	struct mutex lock;
+	struct aesd_buffer_entry buffer_entry;	/* command written so far, up to its newline */
+	struct rw_semaphore buffer_lock;		/* circular_buffer, shared by readers */
+	struct mutex write_lock;				/* buffer_entry, one writer at a time */
 };
 
 
@@ -0,0 +1,499 @@
+/*
+ * @filename 		:	aesdreaders.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Multi-reader scaling test for aesdchar, built with
+ *						"make readers". Fills the device with -p lines of
+ *						the form "w%08u\n", then reads it from start to
+ *						end with 1, 2, 4, ... up to -r reader threads for
+ *						-t seconds each and prints the read throughput of
+ *						every step next to the single reader one. Readers
+ *						share the buffer lock, so the throughput should
+ *						grow with the readers up to the number of cpus.
+ *
+ *						With -w a writer keeps appending lines while the
+ *						readers run, its rate shows writers are not held
+ *						off by the readers either.
+ *
+ *						Every read is checked to hold whole, consecutive
+ *						lines, a read torn by a concurrent write fails the
+ *						test. Load the module with an aesd_depth of at
+ *						least -p and nothing else writing to the device.
+ *
+ *						Example:
+ *							./aesdchar_load aesd_depth=4096
+ *							./aesdreaders -p 4096 -r 8 -w
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define ERROR				(-1)
+#define SUCCESS				(0)
+
+#define DEFAULT_DEVICE		"/dev/aesdchar"
+#define DEFAULT_READERS		(8)
+#define DEFAULT_SECONDS		(1.0)
+#define DEFAULT_PREFILL		(1024)
+#define LINE_SIZE			(10)		//"w%08u\n"
+#define LINE_NUMBERS		(100000000)	//eight digits
+#define READ_SIZE			(400 * LINE_SIZE)
+
+/*------------------------------------------------------------------------*/
+/*							TEST STRUCTURES								  */
+/*------------------------------------------------------------------------*/
+struct readers_config
+{
+	const char *device;
+	int readers;				//most readers of the last step
+	double seconds;				//per step
+	unsigned int prefill;		//lines written before reading
+	bool writer;				//keep writing while reading
+	double min_speedup;			//of the last step, 0 = not checked
+};
+
+struct reader
+{
+	pthread_t thread_id;
+	uint64_t bytes;
+	uint64_t reads;
+	uint64_t torn;
+	int error;					//errno of a failed open() or read()
+};
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static struct readers_config config =
+{
+	.device 		= DEFAULT_DEVICE,
+	.readers 		= DEFAULT_READERS,
+	.seconds 		= DEFAULT_SECONDS,
+	.prefill 		= DEFAULT_PREFILL,
+	.writer 		= false,
+	.min_speedup 	= 0,
+};
+
+static uint64_t deadline;				//of the running step
+static unsigned int next_line = 0;		//written by one thread at a time
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	parses the command line into config
+ *
+ * @parameters	:	argc, argv	:	arguments passed to main()
+ *
+ * @returns		:	none, exits with EXIT_FAILURE on invalid arguments
+ */
+static void parse_arguments(int argc, char *argv[]);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	runs count readers, and the writer with -w, until
+ *					the step ends
+ *
+ * @parameters	:	count	:	number of readers
+ *					rate	:	set to the bytes read per second
+ *
+ * @returns		:	SUCCESS if every read was whole, ERROR otherwise
+ */
+static int readers_step(int count, double *rate);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	reads the device from start to end until the
+ *					deadline, checking every read
+ *
+ * @parameters	:	arg	:	struct reader of the thread
+ *
+ * @returns		:	NULL
+ */
+static void* reader_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	appends lines until the deadline
+ *
+ * @parameters	:	arg	:	uint64_t counting the lines written
+ *
+ * @returns		:	NULL
+ */
+static void* writer_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	checks that buffer holds whole lines numbered one
+ *					after another
+ *
+ * @parameters	:	buffer	:	data of one read
+ *					length	:	bytes in buffer
+ *
+ * @returns		:	true if the read is whole, false if it is torn
+ */
+static bool lines_whole(const char *buffer, size_t length);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	writes the next line
+ *
+ * @parameters	:	fd	:	device opened for writing
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int write_line(int fd);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	monotonic clock in nanoseconds
+ */
+static uint64_t readers_now(void);
+
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		:	Application entry point
+ *					Fills the device, then runs one step per reader
+ *					count and prints its throughput.
+ */
+/*------------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	double rate, single = 0, speedup = 0;
+	int fd, count, status = SUCCESS;
+	unsigned int i;
+
+	parse_arguments(argc, argv);
+
+	fd = open(config.device, O_WRONLY | O_APPEND);
+	if(fd == ERROR)
+	{
+		fprintf(stderr, "open() failed for %s: %s\n", config.device, strerror(errno));
+		exit(EXIT_FAILURE);
+	}
+	for(i = 0; i < config.prefill; i++)
+	{
+		if(write_line(fd) == ERROR)
+		{
+			close(fd);
+			exit(EXIT_FAILURE);
+		}
+	}
+	close(fd);
+	/*------------------------------------------------------------------------*/
+	printf("device %s prefill %u lines %.1f s per step writer %s\n",
+			config.device, config.prefill, config.seconds, config.writer ? "on" : "off");
+	for(count = 1; ; count *= 2)
+	{
+		//the last step runs with all readers, also when that is no power of two
+		if(count > config.readers)
+		{
+			count = config.readers;
+		}
+		if(readers_step(count, &rate) == ERROR)
+		{
+			status = ERROR;
+		}
+		if(count == 1)
+		{
+			single = rate;
+		}
+		speedup = (single > 0) ? rate / single : 0;
+		printf("readers %d MB/s %.1f speedup %.2f\n", count, rate / 1e6, speedup);
+		if(count == config.readers)
+		{
+			break;
+		}
+	}
+
+	if((config.min_speedup > 0) && (speedup < config.min_speedup))
+	{
+		fprintf(stderr, "speedup %.2f with %d readers, expected at least %.2f\n",
+				speedup, config.readers, config.min_speedup);
+		status = ERROR;
+	}
+	return (status == SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*------------------------------------------------------------------------*/
+static void parse_arguments(int argc, char *argv[])
+{
+	int option;
+	char *end;
+
+	while((option = getopt(argc, argv, "d:r:t:p:m:w")) != ERROR)
+	{
+		switch(option)
+		{
+			case 'd':
+				config.device = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'r':
+				config.readers = (int) strtol(optarg, &end, 10);
+				if((*end != '\0') || (config.readers <= 0))
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 't':
+				config.seconds = strtod(optarg, &end);
+				if((*end != '\0') || (config.seconds <= 0))
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'p':
+				config.prefill = (unsigned int) strtoul(optarg, &end, 10);
+				if(*end != '\0')
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'm':
+				config.min_speedup = strtod(optarg, &end);
+				if((*end != '\0') || (config.min_speedup < 0))
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'w':
+				config.writer = true;
+				break;
+			/*------------------------------------------------------------------------*/
+			default:
+				goto usage;
+		}
+	}
+	return;
+
+usage:
+	fprintf(stderr, "Usage: %s [-d device] [-r readers] [-t seconds per step]"
+					" [-p prefill lines] [-m min speedup] [-w]\n", argv[0]);
+	exit(EXIT_FAILURE);
+}
+/*------------------------------------------------------------------------*/
+static int readers_step(int count, double *rate)
+{
+	struct reader *readers;
+	pthread_t writer_id;
+	uint64_t start, elapsed, bytes = 0, reads = 0, torn = 0, lines = 0;
+	int i, status, result = SUCCESS;
+
+	readers = (struct reader *) calloc(count, sizeof(struct reader));
+	if(readers == NULL)
+	{
+		fprintf(stderr, "calloc() failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	start 		= readers_now();
+	deadline 	= start + (uint64_t) (config.seconds * 1e9);
+	for(i = 0; i < count; i++)
+	{
+		status = pthread_create(&readers[i].thread_id, NULL, reader_thread, &readers[i]);
+		if(status != SUCCESS)
+		{
+			fprintf(stderr, "pthread_create() failed with error code: %d\n", status);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if(config.writer)
+	{
+		status = pthread_create(&writer_id, NULL, writer_thread, &lines);
+		if(status != SUCCESS)
+		{
+			fprintf(stderr, "pthread_create() failed with error code: %d\n", status);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		pthread_join(readers[i].thread_id, NULL);
+	}
+	if(config.writer)
+	{
+		pthread_join(writer_id, NULL);
+	}
+	elapsed = readers_now() - start;
+	/*------------------------------------------------------------------------*/
+	for(i = 0; i < count; i++)
+	{
+		bytes 	+= readers[i].bytes;
+		reads 	+= readers[i].reads;
+		torn 	+= readers[i].torn;
+		if(readers[i].error != 0)
+		{
+			fprintf(stderr, "reader %d failed: %s\n", i, strerror(readers[i].error));
+			result = ERROR;
+		}
+	}
+	if((reads == 0) || (torn > 0))
+	{
+		fprintf(stderr, "%llu of %llu reads torn with %d readers\n",
+				(unsigned long long) torn, (unsigned long long) reads, count);
+		result = ERROR;
+	}
+	if(config.writer)
+	{
+		printf("writer lines/s %.0f\n", lines / (elapsed / 1e9));
+	}
+
+	*rate = bytes / (elapsed / 1e9);
+	free(readers);
+	return result;
+}
+/*------------------------------------------------------------------------*/
+static void* reader_thread(void *arg)
+{
+	struct reader *reader = (struct reader *) arg;
+	char buffer[READ_SIZE];
+	off_t position;
+	ssize_t status;
+	int fd;
+
+	fd = open(config.device, O_RDONLY);
+	if(fd == ERROR)
+	{
+		reader->error = errno;
+		return NULL;
+	}
+
+	while(readers_now() < deadline)
+	{
+		//one pass over the device, the same as cat
+		for(position = 0; ; position += status)
+		{
+			status = pread(fd, buffer, sizeof(buffer), position);
+			if(status == 0)
+			{
+				break;
+			}
+			if(status == ERROR)
+			{
+				if(errno == EINTR)
+				{
+					status = 0;
+					continue;
+				}
+				reader->error = errno;
+				close(fd);
+				return NULL;
+			}
+			reader->bytes += status;
+			reader->reads++;
+			if(!lines_whole(buffer, status))
+			{
+				reader->torn++;
+			}
+		}
+	}
+
+	close(fd);
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static void* writer_thread(void *arg)
+{
+	uint64_t *lines = (uint64_t *) arg;
+	int fd;
+
+	fd = open(config.device, O_WRONLY | O_APPEND);
+	if(fd == ERROR)
+	{
+		fprintf(stderr, "open() failed for %s: %s\n", config.device, strerror(errno));
+		return NULL;
+	}
+
+	while(readers_now() < deadline)
+	{
+		if(write_line(fd) == ERROR)
+		{
+			break;
+		}
+		(*lines)++;
+	}
+
+	close(fd);
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static bool lines_whole(const char *buffer, size_t length)
+{
+	unsigned long number, previous = 0;
+	size_t i, j;
+
+	//the oldest lines are dropped a whole line at a time, so reads stay aligned
+	if((length % LINE_SIZE) != 0)
+	{
+		return false;
+	}
+
+	for(i = 0; i < length; i += LINE_SIZE)
+	{
+		if((buffer[i] != 'w') || (buffer[i + LINE_SIZE - 1] != '\n'))
+		{
+			return false;
+		}
+		number = 0;
+		for(j = 1; j < LINE_SIZE - 1; j++)
+		{
+			if((buffer[i + j] < '0') || (buffer[i + j] > '9'))
+			{
+				return false;
+			}
+			number = (number * 10) + (buffer[i + j] - '0');
+		}
+		//a read sees the buffer as of one moment, no line missing in between
+		if((i > 0) && (number != (previous + 1) % LINE_NUMBERS))
+		{
+			return false;
+		}
+		previous = number;
+	}
+	return true;
+}
+/*------------------------------------------------------------------------*/
+static int write_line(int fd)
+{
+	char line[LINE_SIZE + 1];
+	ssize_t status;
+
+	snprintf(line, sizeof(line), "w%08u\n", next_line % LINE_NUMBERS);
+	do
+	{
+		status = write(fd, line, LINE_SIZE);
+	} while((status == ERROR) && (errno == EINTR));
+
+	if(status != LINE_SIZE)
+	{
+		fprintf(stderr, "write() failed for %s: %s\n", config.device,
+				(status == ERROR) ? strerror(errno) : "short write");
+		return ERROR;
+	}
+	next_line++;
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static uint64_t readers_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
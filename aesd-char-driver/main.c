@@ -9,6 +9,12 @@
  * 					Updated by Tanmay Mahendra Kothale on 13th March 2022
  * 					Changes for ECEN 5713 Advanced Embedded Software Development
  * 					Assignment 8
+ *
+ * 					Updated by Tanmay Mahendra Kothale on 17th October 2026
+ * 					History depth set with the aesd_depth module parameter,
+ * 					reads span entries, read_iter/write_iter, llseek and
+ * 					the AESDCHAR_IOCSEEKTO ioctl, readers in parallel with
+ * 					each other and with the copy of a write
  * 
  * @date 2019-10-22
  * @copyright Copyright (c) 2019
@@ -16,16 +22,30 @@
  */
 
 #include <linux/module.h>
+#include <linux/moduleparam.h>
 #include <linux/init.h>
 #include <linux/printk.h>
 #include <linux/types.h>
 #include <linux/cdev.h>
 #include <linux/slab.h>
+#include <linux/mutex.h>
+#include <linux/rwsem.h>
 #include <linux/fs.h> // file_operations
+#include <linux/uio.h> // iov_iter
+#include <linux/uaccess.h> // copy_from_user
 #include "aesdchar.h"
+#include "aesd_ioctl.h"
 int aesd_major =   0; // use dynamic major
 int aesd_minor =   0;
 
+/**
+ * Number of write commands kept, e.g. aesdchar_load aesd_depth=65536.
+ * Power of two depths are a little cheaper to index.
+ */
+static unsigned int aesd_depth = AESDCHAR_MAX_WRITE_OPERATIONS_SUPPORTED;
+module_param(aesd_depth, uint, S_IRUGO);
+MODULE_PARM_DESC(aesd_depth, "number of write commands kept in the circular buffer");
+
 MODULE_AUTHOR("Tanmay Mahendra Kothale");
 MODULE_LICENSE("Dual BSD/GPL");
 
@@ -62,77 +82,84 @@ int aesd_release(struct inode *inode, struct file *filp)
 }
 
 /**
- * @desc the release system call used to release andy kernel resources.
- * @param filp the kernel file structure passed from caller.
- * @param buf the buffer pointer at which the read data needs to be stored.
- * @param count the number of bytes required to be read from kernel buffer.
- * @param f_pos the entry offset location in kernel buffer from where data will be read.
- * @return no of bytes successfully read.
+ * @desc reads the entries starting at the file position into the iterator, as many
+ * consecutive entries as fit. Serves read(), readv() and io_uring.
+ * @param iocb the kernel I/O control block, ki_pos is the file position.
+ * @param to the user buffers the data is copied to.
+ * @return no of bytes successfully read, 0 at the end of the buffer.
  */
-ssize_t aesd_read(struct file *filp, char __user *buf, size_t count,
-                loff_t *f_pos)
+ssize_t aesd_read_iter(struct kiocb *iocb, struct iov_iter *to)
 {
 	ssize_t retval = 0;
 	struct aesd_dev *device;
+	struct aesd_circular_buffer *buffer;
 	struct aesd_buffer_entry *read_entry = NULL;
-	ssize_t read_offset = 0;
-	ssize_t read_data = 0;
+	size_t read_offset = 0;
+	size_t chunk, copied, index;
 
-	PDEBUG("read %zu bytes with offset %lld",count,*f_pos);
+	PDEBUG("read %zu bytes with offset %lld",iov_iter_count(to),iocb->ki_pos);
 
-	device = (struct aesd_dev*) filp->private_data;
+	device = (struct aesd_dev*) iocb->ki_filp->private_data;
+	buffer = &device->circular_buffer;
 
-	if(filp == NULL || buf == NULL || f_pos == NULL)
-	{
-		return -EFAULT; 
-	}
-	
-	if(mutex_lock_interruptible(&device->lock))
+	//readers only share the lock, a writer takes it for an add, never for a copy
+	if(down_read_killable(&device->buffer_lock))
 	{
-		PDEBUG(KERN_ERR "could not acquire mutex lock");
+		PDEBUG(KERN_ERR "could not acquire buffer lock");
 		return -ERESTARTSYS;
 	}
 
-	read_entry = aesd_circular_buffer_find_entry_offset_for_fpos(&(device->circular_buffer), *f_pos, &read_offset); 
-	if(read_entry == NULL)
-	{
-		goto handle_error;
-	}
-	else
+	read_entry = aesd_circular_buffer_find_entry_offset_for_fpos(buffer, iocb->ki_pos, &read_offset);
+	while((read_entry != NULL) && (iov_iter_count(to) > 0))
 	{
-		if(count > (read_entry->size - read_offset))
+		chunk = min(read_entry->size - read_offset, iov_iter_count(to));
+		copied = copy_to_iter(read_entry->buffptr + read_offset, chunk, to);
+		retval += copied;
+		if(copied < chunk)
 		{
-			count = read_entry->size - read_offset;
+			//fault in the user buffer, report what was copied
+			if(retval == 0)
+			{
+				retval = -EFAULT;
+			}
+			break;
 		}
-	}
 
-	read_data = copy_to_user(buf, (read_entry->buffptr + read_offset), count);
-	
-	retval = count - read_data;
-	*f_pos += retval;
+		//the next entry follows in the array, up to in_offs
+		index = aesd_circular_buffer_wrap(buffer, (read_entry - buffer->entry) + 1);
+		read_entry = (index == buffer->in_offs) ? NULL : &buffer->entry[index];
+		read_offset = 0;
+	}
 
-handle_error:
-	mutex_unlock(&(device->lock));
+	if(retval > 0)
+	{
+		iocb->ki_pos += retval;
+	}
+	up_read(&device->buffer_lock);
 
 	return retval;
 }
 
 /**
- * @desc the release system call used to release andy kernel resources.
- * @param filp the kernel file structure passed from caller.
- * @param buf the buffer pointer which contains the data to be written at kernel buffer entry
- * @param count the number of bytes required to be written to kernel buffer.
- * @param f_pos the file postion location which will be updated after each write.
+ * @desc appends the data to the command being written. Every newline completes a
+ * command, which becomes an entry of the circular buffer, so a writev() of several
+ * commands adds one entry each. Serves write(), writev() and io_uring.
+ * The data is copied in under write_lock alone, readers are only held off while a
+ * completed command is added.
+ * @param iocb the kernel I/O control block.
+ * @param from the user buffers holding the data to write.
  * @return no of bytes successfully written.
  */
-ssize_t aesd_write(struct file *filp, const char __user *buf, size_t count,
-                loff_t *f_pos)
+ssize_t aesd_write_iter(struct kiocb *iocb, struct iov_iter *from)
 {	
 	struct aesd_dev *device;
-	const char *new_entry = NULL;
-	ssize_t retval = -ENOMEM;
-	ssize_t unwritten_bytes = 0;
-	PDEBUG("write %zu bytes with offset %lld",count,*f_pos);
+	struct aesd_buffer_entry *pending;
+	struct aesd_buffer_entry command;
+	const char *old_entry = NULL;
+	char *data, *rest, *newline;
+	size_t count = iov_iter_count(from);
+	size_t copied, scanned, length;
+	PDEBUG("write %zu bytes with offset %lld",count,iocb->ki_pos);
 	
 	//check arguement errors
 	if(count == 0)
@@ -140,63 +167,152 @@ ssize_t aesd_write(struct file *filp, const char __user *buf, size_t count,
 		return 0;
 	}
 
-	if(filp == NULL || buf == NULL || f_pos== NULL)
-	{
-		return -EFAULT;
-	}
+	device = (struct aesd_dev*) iocb->ki_filp->private_data;
+	pending = &device->buffer_entry;
 
-	device = (struct aesd_dev*) filp->private_data;
-
-	if(mutex_lock_interruptible(&(device->lock)))
+	if(mutex_lock_interruptible(&device->write_lock))
 	{
-		PDEBUG(KERN_ERR "could not acquire mutex lock");
+		PDEBUG(KERN_ERR "could not acquire write lock");
 		return -ERESTARTSYS;
 	}
 	
-	if(device->buffer_entry.size == 0)
+	//krealloc() of NULL allocates, on failure the pending command is kept
+	data = krealloc(pending->buffptr, (pending->size + count)*sizeof(char), GFP_KERNEL);
+	if(data == NULL)
 	{
-		device->buffer_entry.buffptr = kmalloc(count*sizeof(char), GFP_KERNEL);
-
-		if(device->buffer_entry.buffptr == NULL)
-		{
-			PDEBUG("kmalloc error");
-			goto exit_error;
-		}
+		PDEBUG("krealloc error");
+		mutex_unlock(&device->write_lock);
+		return -ENOMEM;
 	}
+	pending->buffptr = data;
 
-	else
+	copied = copy_from_iter(data + pending->size, count, from);
+	if(copied == 0)
 	{
-		device->buffer_entry.buffptr = krealloc(device->buffer_entry.buffptr, (device->buffer_entry.size + count)*sizeof(char), GFP_KERNEL);
+		mutex_unlock(&device->write_lock);
+		return -EFAULT;
+	}
+	scanned = pending->size;
+	pending->size += copied;
 
-		if(device->buffer_entry.buffptr == NULL)
+	//only the new bytes can hold a newline, older ones were split off before
+	while((pending->size > scanned) &&
+		((newline = memchr(data + scanned, '\n', pending->size - scanned)) != NULL))
+	{
+		length = newline - data + 1;
+		rest = NULL;
+		if(length < pending->size)
 		{
-			PDEBUG("krealloc error");
-			goto exit_error;
+			rest = kmalloc(pending->size - length, GFP_KERNEL);
+			if(rest == NULL)
+			{
+				//keep the rest in the same entry rather than losing it
+				PDEBUG("kmalloc error");
+				length = pending->size;
+			}
+			else
+			{
+				memcpy(rest, data + length, pending->size - length);
+			}
 		}
+
+		command.buffptr = data;
+		command.size = length;
+		//not killable, the data is already taken from the writer
+		down_write(&device->buffer_lock);
+		old_entry = aesd_circular_buffer_add_entry(&device->circular_buffer, &command);
+		up_write(&device->buffer_lock);
+		//no reader can still be copying from the entry overwritten
+		kfree(old_entry);
+
+		pending->size -= length;
+		pending->buffptr = rest;
+		data = rest;
+		scanned = 0;
 	}
 
+	mutex_unlock(&device->write_lock);
 
-	unwritten_bytes = copy_from_user((void *)(device->buffer_entry.buffptr + device->buffer_entry.size), buf, count);
-	retval = count - unwritten_bytes; 
-	device->buffer_entry.size += retval;
+	return copied;
+}
 
-	if(memchr(device->buffer_entry.buffptr, '\n', device->buffer_entry.size))
+/**
+ * @desc moves the file position within the bytes of all commands in the buffer.
+ * @param filp the kernel file structure passed from caller.
+ * @param offset the new position, relative to whence.
+ * @param whence SEEK_SET, SEEK_CUR or SEEK_END.
+ * @return the new position, -EINVAL for a position outside of the buffer.
+ */
+loff_t aesd_llseek(struct file *filp, loff_t offset, int whence)
+{
+	struct aesd_dev *device;
+	loff_t size;
+
+	PDEBUG("llseek %lld whence %d",offset,whence);
+
+	device = (struct aesd_dev*) filp->private_data;
+
+	if(down_read_killable(&device->buffer_lock))
 	{
-		new_entry = aesd_circular_buffer_add_entry(&device->circular_buffer, &device->buffer_entry); 
-		if(new_entry)
-		{
-			kfree(new_entry);
-		}
+		PDEBUG(KERN_ERR "could not acquire buffer lock");
+		return -ERESTARTSYS;
+	}
+	size = aesd_circular_buffer_size(&device->circular_buffer);
+	up_read(&device->buffer_lock);
 
-		device->buffer_entry.buffptr = NULL;
-		device->buffer_entry.size = 0;
+	//the total is kept up to date by every add, no walk over the entries
+	return fixed_size_llseek(filp, offset, whence, size);
+}
 
+/**
+ * @desc handles AESDCHAR_IOCSEEKTO, moving the file position to a byte of a command.
+ * @param filp the kernel file structure passed from caller.
+ * @param cmd the ioctl command.
+ * @param arg user pointer to a struct aesd_seekto.
+ * @return 0 on success, -EINVAL for a command or byte not in the buffer, -ENOTTY for
+ * an unknown ioctl.
+ */
+long aesd_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
+{
+	struct aesd_dev *device;
+	struct aesd_circular_buffer *buffer;
+	struct aesd_buffer_entry *entry;
+	struct aesd_seekto seekto;
+	long retval = -EINVAL;
+
+	if((_IOC_TYPE(cmd) != AESD_IOC_MAGIC) || (_IOC_NR(cmd) > AESDCHAR_IOC_MAXNR) ||
+		(cmd != AESDCHAR_IOCSEEKTO))
+	{
+		return -ENOTTY;
 	}
 
-	PDEBUG("not doing k_free for now");
+	if(copy_from_user(&seekto, (const void __user *) arg, sizeof(seekto)))
+	{
+		return -EFAULT;
+	}
+	PDEBUG("seekto command %u offset %u",seekto.write_cmd,seekto.write_cmd_offset);
 
-exit_error:
-	mutex_unlock(&device->lock);
+	device = (struct aesd_dev*) filp->private_data;
+	buffer = &device->circular_buffer;
+
+	if(down_read_killable(&device->buffer_lock))
+	{
+		PDEBUG(KERN_ERR "could not acquire buffer lock");
+		return -ERESTARTSYS;
+	}
+
+	//commands are indexed from out_offs, their offset gives the position at once
+	if(seekto.write_cmd < aesd_circular_buffer_count(buffer))
+	{
+		entry = &buffer->entry[aesd_circular_buffer_wrap(buffer, buffer->out_offs + seekto.write_cmd)];
+		if(seekto.write_cmd_offset < entry->size)
+		{
+			filp->f_pos = (entry->offset - buffer->first_offset) + seekto.write_cmd_offset;
+			retval = 0;
+		}
+	}
+
+	up_read(&device->buffer_lock);
 
 	return retval;
 }
@@ -204,8 +320,10 @@ exit_error:
 struct file_operations aesd_fops = 
 {
 	.owner =    THIS_MODULE,
-	.read =     aesd_read,
-	.write =    aesd_write,
+	.llseek =   aesd_llseek,
+	.read_iter = aesd_read_iter,
+	.write_iter = aesd_write_iter,
+	.unlocked_ioctl = aesd_ioctl,
 	.open =     aesd_open,
 	.release =  aesd_release,
 };
@@ -247,14 +365,22 @@ int aesd_init_module(void)
 	}
 	memset(&aesd_device,0,sizeof(struct aesd_dev));
 
-	//Initialize the mutex and circular buffer
-	mutex_init(&aesd_device.lock);
-	aesd_circular_buffer_init(&aesd_device.circular_buffer);
+	//Initialize the locks and circular buffer
+	init_rwsem(&aesd_device.buffer_lock);
+	mutex_init(&aesd_device.write_lock);
+	status = aesd_circular_buffer_init_depth(&aesd_device.circular_buffer, aesd_depth);
+	if(status)
+	{
+		printk(KERN_WARNING "Can't allocate %u entries\n", aesd_depth);
+		unregister_chrdev_region(dev, 1);
+		return status;
+	}
 
 	status = aesd_setup_cdev(&aesd_device);
 
 	if(status) 
 	{
+		aesd_circular_buffer_release(&aesd_device.circular_buffer);
 		unregister_chrdev_region(dev, 1);
 	}
 	return status;
@@ -268,7 +394,7 @@ void aesd_cleanup_module(void)
 {
 	//free circular buffer entries
 	struct aesd_buffer_entry *entry = NULL;
-	uint8_t index = 0; 
+	size_t index = 0; 
 
 	dev_t devno = MKDEV(aesd_major, aesd_minor);
 
@@ -282,6 +408,7 @@ void aesd_cleanup_module(void)
 			kfree(entry->buffptr);
 		}
 	}
+	aesd_circular_buffer_release(&aesd_device.circular_buffer);
 
 	unregister_chrdev_region(devno, 1);
 }
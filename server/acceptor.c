@@ -0,0 +1,583 @@
+/*
+ * @filename 		:	acceptor.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						SO_REUSEPORT listeners and accept loops.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#define _GNU_SOURCE				//pthread_setaffinity_np(), accept4()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <syslog.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "aesdsocket.h"
+#include "acceptor.h"
+#include "event-loop.h"
+#include "server-stats.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define NETSTAT_PATH		"/proc/net/netstat"
+#define NETSTAT_LINE_SIZE	(8192)
+#define ACCEPT_BACKOFF_NS	(10 * 1000 * 1000)	//out of descriptors or memory
+
+/*------------------------------------------------------------------------*/
+/*							ACCEPTOR STRUCTURE							  */
+/*------------------------------------------------------------------------*/
+struct acceptor
+{
+	pthread_t thread_id;
+	int sockfd;				//listener of this acceptor
+	int cpu;				//cpu to pin to, -1 for none
+};
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static struct acceptor		*acceptors			= NULL;
+static int					acceptor_count		= 0;
+static int					acceptor_threads	= 0;	//threads spawned so far
+static volatile bool		acceptors_stopping	= false;
+static int					stop_fd				= ERROR;	//readable once stopping
+static uint64_t				base_overflows		= 0;	//kernel counters at listen()
+static uint64_t				base_drops			= 0;
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	thread function of an acceptor
+ *
+ * @parameters	:	arg	:	struct acceptor to run
+ *
+ * @returns		:	NULL
+ */
+static void* acceptor_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	pins the calling thread if requested, then waits for
+ *					the listener of the acceptor and drains it until
+ *					stopped. On an unrecoverable failure the process
+ *					is sent SIGTERM, a server that no longer accepts
+ *					shuts down rather than linger.
+ *
+ * @parameters	:	acceptor	:	acceptor to run
+ *
+ * @returns		:	none
+ */
+static void acceptor_loop(struct acceptor *acceptor);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	allocates the acceptors and the stop eventfd
+ *
+ * @parameters	:	count	:	number of acceptors
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int acceptor_alloc(int count);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	accepts every connection waiting on the listener
+ *					and queues them for the event loops
+ *
+ * @parameters	:	acceptor	:	acceptor to drain
+ *
+ * @returns		:	SUCCESS once the accept queue is empty, ERROR on
+ *					an unrecoverable accept4() failure
+ */
+static int acceptor_drain(struct acceptor *acceptor);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	tells accept4() errors of a single connection from
+ *					errors of the listener. Linux reports network
+ *					errors pending on a new connection through
+ *					accept4() itself.
+ *
+ * @parameters	:	error	:	errno of accept4()
+ *
+ * @returns		:	true if only that connection is lost
+ */
+static bool acceptor_connection_error(int error);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	reads ListenOverflows and ListenDrops of the network
+ *					namespace
+ *
+ * @parameters	:	overflows	:	filled with ListenOverflows
+ *					drops		:	filled with ListenDrops
+ *
+ * @returns		:	SUCCESS on success, ERROR if they are unavailable
+ */
+static int acceptor_read_netstat(uint64_t *overflows, uint64_t *drops);
+
+/*------------------------------------------------------------------------*/
+int acceptor_open(const struct addrinfo *address, int count)
+{
+	int i;
+
+	if(acceptor_alloc(count) == ERROR)
+	{
+		return ERROR;
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		acceptors[i].sockfd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+										address->ai_protocol);
+		if(acceptors[i].sockfd == ERROR)
+		{
+			syslog(LOG_ERR,"socket() failed\n");
+			#if DEBUG
+				printf("socket() failed\n");
+			#endif
+			return ERROR;
+		}
+
+		if(setsockopt(acceptors[i].sockfd, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int)) == ERROR)
+		{
+			syslog(LOG_ERR,"setsockopt() failed\n");
+			#if DEBUG
+				printf("setsockopt() failed\n");
+			#endif
+			return ERROR;
+		}
+
+		//every listener gets its own accept queue, the kernel picks one
+		//per incoming connection by its address hash
+		if((count > 1) &&
+			(setsockopt(acceptors[i].sockfd, SOL_SOCKET, SO_REUSEPORT, &(int){1}, sizeof(int)) == ERROR))
+		{
+			syslog(LOG_ERR,"setsockopt() failed\n");
+			#if DEBUG
+				printf("setsockopt() failed\n");
+			#endif
+			return ERROR;
+		}
+
+		if(bind(acceptors[i].sockfd, address->ai_addr, address->ai_addrlen) == ERROR)
+		{
+			syslog(LOG_ERR,"bind() failed\n");
+			#if DEBUG
+				printf("bind() failed\n");
+			#endif
+			return ERROR;
+		}
+	}
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int acceptor_adopt(const int *fds, int count)
+{
+	int i;
+
+	if(acceptor_alloc(count) == ERROR)
+	{
+		return ERROR;
+	}
+
+	//same open sockets as in the predecessor, still non-blocking
+	for(i = 0; i < count; i++)
+	{
+		acceptors[i].sockfd = fds[i];
+	}
+
+	syslog(LOG_INFO,"Adopted %d listener(s)\n", count);
+	#if DEBUG
+		printf("Adopted %d listener(s)\n", count);
+	#endif
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int acceptor_listeners(int *fds, int max)
+{
+	int i;
+
+	for(i = 0; (i < acceptor_count) && (i < max); i++)
+	{
+		fds[i] = acceptors[i].sockfd;
+	}
+	return i;
+}
+/*------------------------------------------------------------------------*/
+int acceptor_listen(int backlog, int defer_seconds)
+{
+	int i;
+
+	for(i = 0; i < acceptor_count; i++)
+	{
+		//a client that connects without sending stays in the kernel
+		//for up to defer_seconds instead of occupying a connection
+		if((defer_seconds > 0) &&
+			(setsockopt(acceptors[i].sockfd, IPPROTO_TCP, TCP_DEFER_ACCEPT,
+						&defer_seconds, sizeof(int)) == ERROR))
+		{
+			syslog(LOG_ERR,"setsockopt() failed\n");
+			#if DEBUG
+				printf("setsockopt() failed\n");
+			#endif
+			return ERROR;
+		}
+
+		if(listen(acceptors[i].sockfd, backlog) == ERROR)
+		{
+			syslog(LOG_ERR,"listen() failed\n");
+			#if DEBUG
+				printf("listen() failed\n");
+			#endif
+			return ERROR;
+		}
+	}
+
+	acceptor_read_netstat(&base_overflows, &base_drops);
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int acceptor_start(bool pin)
+{
+	sigset_t blocked, previous;
+	long cpus;
+	int i, status;
+
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if(cpus <= 0)
+	{
+		cpus = 1;
+	}
+	/*------------------------------------------------------------------------*/
+	for(i = 0; pin && (i < acceptor_count); i++)
+	{
+		acceptors[i].cpu = (int) (i % cpus);
+
+		//prefer the listener whose acceptor runs where the packet was
+		//received, only a hint for the reuseport selection
+		setsockopt(acceptors[i].sockfd, SOL_SOCKET, SO_INCOMING_CPU,
+					&acceptors[i].cpu, sizeof(int));
+	}
+
+	sigfillset(&blocked);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	for(i = 0; i < acceptor_count; i++)
+	{
+		status = pthread_create(&acceptors[i].thread_id, NULL, acceptor_thread, &acceptors[i]);
+		if(status != SUCCESS)
+		{
+			syslog(LOG_ERR,"pthread_create() failed with error code: %d\n",status);
+			#if DEBUG
+				printf("pthread_create() failed with error code: %d\n",status);
+			#endif
+			pthread_sigmask(SIG_SETMASK, &previous, NULL);
+			return ERROR;
+		}
+		acceptor_threads++;
+	}
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+	syslog(LOG_INFO,"Started %d acceptor(s)%s\n", acceptor_count, pin ? ", pinned" : "");
+	#if DEBUG
+		printf("Started %d acceptor(s)%s\n", acceptor_count, pin ? ", pinned" : "");
+	#endif
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+void acceptor_stop(void)
+{
+	int i;
+
+	if(acceptors == NULL)
+	{
+		return;
+	}
+
+	//never read, so it wakes every acceptor for good
+	acceptors_stopping = true;
+	eventfd_write(stop_fd, 1);
+	for(i = 0; i < acceptor_threads; i++)
+	{
+		pthread_join(acceptors[i].thread_id, NULL);
+	}
+	/*------------------------------------------------------------------------*/
+	for(i = 0; i < acceptor_count; i++)
+	{
+		if(acceptors[i].sockfd != ERROR)
+		{
+			close(acceptors[i].sockfd);
+		}
+	}
+	close(stop_fd);
+	stop_fd = ERROR;
+	free(acceptors);
+	acceptors = NULL;
+	acceptor_count = 0;
+	acceptor_threads = 0;
+}
+/*------------------------------------------------------------------------*/
+void acceptor_listen_stats(size_t *queued, uint64_t *overflows, uint64_t *drops)
+{
+	struct tcp_info info;
+	socklen_t length;
+	int i;
+
+	//tcpi_unacked of a listener is the length of its accept queue
+	*queued = 0;
+	for(i = 0; i < acceptor_count; i++)
+	{
+		length = sizeof(info);
+		if(getsockopt(acceptors[i].sockfd, IPPROTO_TCP, TCP_INFO, &info, &length) == SUCCESS)
+		{
+			*queued += info.tcpi_unacked;
+		}
+	}
+
+	if(acceptor_read_netstat(overflows, drops) == ERROR)
+	{
+		*overflows = 0;
+		*drops = 0;
+		return;
+	}
+	*overflows -= base_overflows;
+	*drops -= base_drops;
+}
+/*------------------------------------------------------------------------*/
+static int acceptor_alloc(int count)
+{
+	int i;
+
+	acceptors = (struct acceptor *) calloc(count, sizeof(struct acceptor));
+	if(acceptors == NULL)
+	{
+		syslog(LOG_ERR,"calloc() failed\n");
+		#if DEBUG
+			printf("calloc() failed\n");
+		#endif
+		return ERROR;
+	}
+	acceptor_count = count;
+	for(i = 0; i < count; i++)
+	{
+		acceptors[i].sockfd = ERROR;
+		acceptors[i].cpu = ERROR;
+	}
+
+	stop_fd = eventfd(0, EFD_CLOEXEC);
+	if(stop_fd == ERROR)
+	{
+		syslog(LOG_ERR,"eventfd() failed\n");
+		#if DEBUG
+			printf("eventfd() failed\n");
+		#endif
+		return ERROR;
+	}
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static void* acceptor_thread(void *arg)
+{
+	acceptor_loop((struct acceptor *) arg);
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static void acceptor_loop(struct acceptor *acceptor)
+{
+	struct pollfd fds[2];
+	cpu_set_t cpuset;
+	char name[16];
+
+	snprintf(name, sizeof(name), "acceptor%d", (int) (acceptor - acceptors));
+	stats_thread_register(name);
+
+	if(acceptor->cpu != ERROR)
+	{
+		CPU_ZERO(&cpuset);
+		CPU_SET(acceptor->cpu, &cpuset);
+		if(pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != SUCCESS)
+		{
+			syslog(LOG_ERR,"pthread_setaffinity_np() failed\n");
+			#if DEBUG
+				printf("pthread_setaffinity_np() failed\n");
+			#endif
+		}
+	}
+	/*------------------------------------------------------------------------*/
+	fds[0].fd 		= acceptor->sockfd;
+	fds[0].events 	= POLLIN;
+	fds[1].fd 		= stop_fd;
+	fds[1].events 	= POLLIN;
+	while(!acceptors_stopping)
+	{
+		if(poll(fds, 2, -1) == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			async_log(LOG_ERR,"poll() failed\n");
+			#if DEBUG
+				printf("poll() failed\n");
+			#endif
+			break;
+		}
+		if(fds[1].revents != 0)
+		{
+			break;
+		}
+		if(acceptor_drain(acceptor) == ERROR)
+		{
+			break;
+		}
+	}
+
+	//stop() takes the acceptors down along with everything else
+	if(!acceptors_stopping)
+	{
+		async_log(LOG_ERR,"Acceptor %d stopped, shutting down\n", (int) (acceptor - acceptors));
+		#if DEBUG
+			printf("Acceptor %d stopped, shutting down\n", (int) (acceptor - acceptors));
+		#endif
+		kill(getpid(), SIGTERM);
+	}
+}
+/*------------------------------------------------------------------------*/
+static int acceptor_drain(struct acceptor *acceptor)
+{
+	struct sockaddr_storage client_addr;
+	socklen_t client_addr_size;
+	char ip_address[INET6_ADDRSTRLEN];
+	struct sockaddr_in6 *address;
+	struct timespec backoff;
+	uint64_t accepted;
+	int clientfd;
+
+	while(true)
+	{
+		client_addr_size = sizeof(client_addr);
+		clientfd = accept4(acceptor->sockfd,(struct sockaddr *)&client_addr, &client_addr_size,
+							SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if(clientfd == ERROR)
+		{
+			if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			{
+				return SUCCESS;
+			}
+			if((errno == EINTR) || acceptor_connection_error(errno))
+			{
+				continue;
+			}
+			if((errno == EMFILE) || (errno == ENFILE) || (errno == ENOBUFS) || (errno == ENOMEM))
+			{
+				//the listener stays readable, give the loops time to
+				//close connections instead of spinning on it
+				async_log(LOG_WARNING,"accept4() failed, out of resources\n");
+				#if DEBUG
+					printf("accept4() failed, out of resources\n");
+				#endif
+				backoff.tv_sec 	= 0;
+				backoff.tv_nsec = ACCEPT_BACKOFF_NS;
+				nanosleep(&backoff, NULL);
+				return SUCCESS;
+			}
+			async_log(LOG_ERR,"accept4() failed: %s\n", strerror(errno));
+			#if DEBUG
+				printf("accept4() failed: %s\n", strerror(errno));
+			#endif
+			return ERROR;
+		}
+		accepted = stats_now();
+		address = (struct sockaddr_in6 *)&client_addr;
+		inet_ntop(AF_INET6, &(address->sin6_addr),ip_address,INET6_ADDRSTRLEN);
+		async_log(LOG_INFO,"Accepting connection from %s",ip_address);
+		#if DEBUG
+			printf("Accepting connection from %s",ip_address);
+		#endif
+		/*------------------------------------------------------------------------*/
+		//the connection is owned by an event loop from here on
+		event_loop_add_connection(clientfd);
+		stats_record(STATS_ACCEPT, accepted);
+	}
+}
+/*------------------------------------------------------------------------*/
+static bool acceptor_connection_error(int error)
+{
+	switch(error)
+	{
+		case ECONNABORTED:
+		case EPROTO:
+		case ENETDOWN:
+		case ENETUNREACH:
+		case EHOSTUNREACH:
+		case EHOSTDOWN:
+		case ENONET:
+		case ENOPROTOOPT:
+		case EOPNOTSUPP:
+		case EPERM:				//refused by the firewall
+			return true;
+		default:
+			return false;
+	}
+}
+/*------------------------------------------------------------------------*/
+static int acceptor_read_netstat(uint64_t *overflows, uint64_t *drops)
+{
+	char names[NETSTAT_LINE_SIZE], values[NETSTAT_LINE_SIZE];
+	char *name, *value, *name_save, *value_save;
+	int found = 0;
+	FILE *netstat;
+
+	netstat = fopen(NETSTAT_PATH, "r");
+	if(netstat == NULL)
+	{
+		return ERROR;
+	}
+
+	//pairs of lines, "TcpExt: <names>" followed by "TcpExt: <values>"
+	while((fgets(names, sizeof(names), netstat) != NULL) &&
+			(fgets(values, sizeof(values), netstat) != NULL))
+	{
+		if(strncmp(names, "TcpExt:", strlen("TcpExt:")))
+		{
+			continue;
+		}
+		name = strtok_r(names, " \n", &name_save);
+		value = strtok_r(values, " \n", &value_save);
+		while((name != NULL) && (value != NULL))
+		{
+			if(!strcmp(name, "ListenOverflows"))
+			{
+				*overflows = strtoull(value, NULL, 10);
+				found++;
+			}
+			else if(!strcmp(name, "ListenDrops"))
+			{
+				*drops = strtoull(value, NULL, 10);
+				found++;
+			}
+			name = strtok_r(NULL, " \n", &name_save);
+			value = strtok_r(NULL, " \n", &value_save);
+		}
+	}
+	fclose(netstat);
+
+	return (found == 2) ? SUCCESS : ERROR;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,127 @@
+/*
+ * @filename 		:	acceptor.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Listening sockets and accept loops of aesdsocket.
+ *						With more than one acceptor (-A) every acceptor
+ *						gets its own SO_REUSEPORT listener on port 9000,
+ *						so the kernel spreads incoming connections over
+ *						them and accepting scales with cores instead of
+ *						serializing on one socket. Acceptors may be
+ *						pinned to a cpu each (-P).
+ *
+ *						Every acceptor runs on its own thread and hands
+ *						accepted clients to the event loops. The
+ *						listeners can be handed to a successor process
+ *						and adopted from a predecessor (-H), the kernel
+ *						keeps their accept queues across the restart.
+ *
+ *						Listeners are non-blocking. An acceptor sleeps in
+ *						poll() and on every wakeup drains its accept queue
+ *						with accept4(), so a burst of clients costs one
+ *						wakeup and the clients arrive non-blocking and
+ *						close-on-exec. With TCP_DEFER_ACCEPT (-D) the
+ *						kernel only completes the accept once the client
+ *						sent data.
+ */
+#ifndef ACCEPTOR_H_
+#define ACCEPTOR_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <netdb.h>
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	creates and binds one listener per acceptor, with
+ *					SO_REUSEPORT when there is more than one
+ *
+ * @parameters	:	address	:	address to bind, from getaddrinfo()
+ *					count	:	number of acceptors, at least 1
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int acceptor_open(const struct addrinfo *address, int count);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	takes over listeners already bound by the process
+ *					this one replaces, instead of acceptor_open()
+ *
+ * @parameters	:	fds		:	listeners received from the predecessor,
+ *								owned from now on
+ *					count	:	number of listeners, one acceptor each
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int acceptor_adopt(const int *fds, int count);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	listeners to hand to a successor process
+ *
+ * @parameters	:	fds		:	filled with the listeners, still owned
+ *								by the acceptors
+ *					max		:	size of fds
+ *
+ * @returns		:	number of listeners filled in
+ */
+int acceptor_listeners(int *fds, int max);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	starts listening on every listener
+ *
+ * @parameters	:	backlog			:	backlog passed to listen(), the
+ *										kernel caps it at somaxconn
+ *					defer_seconds	:	TCP_DEFER_ACCEPT timeout, 0 to
+ *										accept on the handshake
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int acceptor_listen(int backlog, int defer_seconds);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	spawns one thread per acceptor
+ *
+ * @parameters	:	pin		:	pin acceptor i to online cpu i (modulo
+ *								the number of cpus)
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int acceptor_start(bool pin);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	wakes the acceptors, waits for the acceptor threads
+ *					and closes the listeners. Connections still in the
+ *					accept queues are lost unless a successor holds the
+ *					listeners too.
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void acceptor_stop(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	listen queue figures for the statistics
+ *
+ * @parameters	:	queued		:	connections waiting in the accept
+ *									queues right now
+ *					overflows	:	connections the kernel dropped on a
+ *									full accept queue since startup
+ *					drops		:	SYNs the kernel dropped for any
+ *									reason since startup
+ *
+ * @returns		:	none. The kernel counters are per network
+ *					namespace (TcpExt in /proc/net/netstat), so they
+ *					include other listeners in it.
+ */
+void acceptor_listen_stats(size_t *queued, uint64_t *overflows, uint64_t *drops);
+
+#endif /* ACCEPTOR_H_ */
+/*EOF*/
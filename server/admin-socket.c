@@ -0,0 +1,284 @@
+/*
+ * @filename 		:	admin-socket.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Admin socket thread answering runtime queries.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#define _GNU_SOURCE				//accept4()
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <syslog.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+
+#include "aesdsocket.h"
+#include "server-stats.h"
+#include "admin-socket.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define ADMIN_BACKLOG			(4)
+#define ADMIN_COMMAND_SIZE		(64)
+#define ADMIN_TIMEOUT_SECONDS	(1)		//a silent client cannot stall the thread
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static pthread_t	admin_thread;
+static bool			admin_running	= false;
+static int			admin_fd		= ERROR;
+static int			stop_fd			= ERROR;
+static const char	*admin_path		= NULL;
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	accepts admin clients one at a time until stop_fd
+ *					is signalled
+ *
+ * @parameters	:	arg	:	unused
+ *
+ * @returns		:	NULL
+ */
+static void* admin_socket_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	reads one command from an admin client and answers it
+ *
+ * @parameters	:	clifd	:	admin client socket
+ *
+ * @returns		:	none
+ */
+static void admin_handle_client(int clifd);
+
+/*------------------------------------------------------------------------*/
+int admin_socket_start(const char *path)
+{
+	struct sockaddr_un address;
+	sigset_t blocked, previous;
+	int status;
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(strlen(path) >= sizeof(address.sun_path))
+	{
+		syslog(LOG_ERR,"admin socket path too long: %s\n", path);
+		#if DEBUG
+			printf("admin socket path too long: %s\n", path);
+		#endif
+		return ERROR;
+	}
+	strcpy(address.sun_path, path);
+	/*------------------------------------------------------------------------*/
+	admin_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if((admin_fd == ERROR) || (stop_fd == ERROR))
+	{
+		syslog(LOG_ERR,"socket()/eventfd() failed\n");
+		#if DEBUG
+			printf("socket()/eventfd() failed\n");
+		#endif
+		goto cleanup;
+	}
+
+	unlink(path);
+	if((bind(admin_fd, (struct sockaddr *) &address, sizeof(address)) == ERROR) ||
+		(listen(admin_fd, ADMIN_BACKLOG) == ERROR))
+	{
+		syslog(LOG_ERR,"bind()/listen() failed for %s\n", path);
+		#if DEBUG
+			printf("bind()/listen() failed for %s\n", path);
+		#endif
+		goto cleanup;
+	}
+	admin_path = path;
+	/*------------------------------------------------------------------------*/
+	sigfillset(&blocked);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	status = pthread_create(&admin_thread, NULL, admin_socket_thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	if(status != SUCCESS)
+	{
+		syslog(LOG_ERR,"pthread_create() failed with error code: %d\n",status);
+		#if DEBUG
+			printf("pthread_create() failed with error code: %d\n",status);
+		#endif
+		unlink(path);
+		admin_path = NULL;
+		goto cleanup;
+	}
+	admin_running = true;
+
+	syslog(LOG_INFO,"Admin socket listening on %s\n", path);
+	return SUCCESS;
+
+cleanup:
+	if(admin_fd != ERROR)
+	{
+		close(admin_fd);
+		admin_fd = ERROR;
+	}
+	if(stop_fd != ERROR)
+	{
+		close(stop_fd);
+		stop_fd = ERROR;
+	}
+	return ERROR;
+}
+/*------------------------------------------------------------------------*/
+void admin_socket_stop(void)
+{
+	if(!admin_running)
+	{
+		return;
+	}
+
+	eventfd_write(stop_fd, 1);
+	pthread_join(admin_thread, NULL);
+	admin_running = false;
+
+	close(admin_fd);
+	close(stop_fd);
+	admin_fd = ERROR;
+	stop_fd = ERROR;
+	unlink(admin_path);
+	admin_path = NULL;
+}
+/*------------------------------------------------------------------------*/
+static void* admin_socket_thread(void *arg)
+{
+	struct pollfd fds[2];
+	int clifd;
+
+	fds[0].fd 		= admin_fd;
+	fds[0].events 	= POLLIN;
+	fds[1].fd 		= stop_fd;
+	fds[1].events 	= POLLIN;
+
+	while(true)
+	{
+		if(poll(fds, 2, -1) == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			syslog(LOG_ERR,"poll() failed\n");
+			#if DEBUG
+				printf("poll() failed\n");
+			#endif
+			break;
+		}
+		if(fds[1].revents & POLLIN)
+		{
+			break;
+		}
+		/*------------------------------------------------------------------------*/
+		clifd = accept4(admin_fd, NULL, NULL, SOCK_CLOEXEC);
+		if(clifd == ERROR)
+		{
+			continue;
+		}
+		admin_handle_client(clifd);
+		close(clifd);
+	}
+
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static void admin_handle_client(int clifd)
+{
+	struct timeval timeout = { .tv_sec = ADMIN_TIMEOUT_SECONDS, .tv_usec = 0 };
+	char command[ADMIN_COMMAND_SIZE];
+	size_t length = 0, answer_length = 0, sent = 0;
+	char *answer = NULL;
+	ssize_t status;
+	FILE *out;
+	int level;
+
+	setsockopt(clifd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(clifd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	//one line, the newline is optional if the client shuts down writing
+	while(length < (sizeof(command) - 1))
+	{
+		status = recv(clifd, command + length, sizeof(command) - 1 - length, 0);
+		if(status <= 0)
+		{
+			break;
+		}
+		length += status;
+		if(memchr(command, '\n', length) != NULL)
+		{
+			break;
+		}
+	}
+	command[length] = '\0';
+	command[strcspn(command, "\r\n")] = '\0';
+	/*------------------------------------------------------------------------*/
+	out = open_memstream(&answer, &answer_length);
+	if(out == NULL)
+	{
+		syslog(LOG_ERR,"open_memstream() failed\n");
+		#if DEBUG
+			printf("open_memstream() failed\n");
+		#endif
+		return;
+	}
+	if(!strcmp(command, "STATS"))
+	{
+		stats_format(out, false);
+	}
+	else if(!strcmp(command, "STATS JSON"))
+	{
+		stats_format(out, true);
+	}
+	else if(!strcmp(command, "LOGLEVEL"))
+	{
+		fprintf(out, "%s\n", async_log_level_name(async_log_threshold));
+	}
+	else if(!strncmp(command, "LOGLEVEL ", strlen("LOGLEVEL ")) &&
+			((level = async_log_parse_level(command + strlen("LOGLEVEL "))) != ERROR))
+	{
+		async_log_set_level(level);
+		fprintf(out, "OK %s\n", async_log_level_name(level));
+	}
+	else
+	{
+		fprintf(out, "ERROR unknown command\n");
+	}
+	fclose(out);
+	/*------------------------------------------------------------------------*/
+	while(sent < answer_length)
+	{
+		status = send(clifd, answer + sent, answer_length - sent, MSG_NOSIGNAL);
+		if(status == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+		sent += status;
+	}
+	free(answer);
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
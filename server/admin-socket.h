@@ -0,0 +1,46 @@
+/*
+ * @filename 		:	admin-socket.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Local UNIX domain socket for runtime queries,
+ *						enabled with -a <path>. It is kept apart from
+ *						port 9000 so commands never end up in the packet
+ *						history. A client sends one command line and
+ *						reads the answer until the socket closes:
+ *
+ *							STATS		:	statistics as plain text
+ *							STATS JSON	:	statistics as one JSON object
+ *							LOGLEVEL	:	current log level
+ *							LOGLEVEL <level>	:	sets the log level,
+ *											err, info, debug, 0 to 7...
+ */
+#ifndef ADMIN_SOCKET_H_
+#define ADMIN_SOCKET_H_
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	binds the admin socket and starts its thread
+ *
+ * @parameters	:	path	:	filesystem path of the socket, an old
+ *								socket at that path is replaced
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int admin_socket_start(const char *path);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	stops the admin thread and removes the socket,
+ *					nothing is done if it was never started
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void admin_socket_stop(void);
+
+#endif /* ADMIN_SOCKET_H_ */
+/*EOF*/
@@ -0,0 +1,79 @@
+/*
+ * @filename 		:	admission.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Connection limit and memory budget.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "aesdsocket.h"
+#include "admission.h"
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static size_t				connection_limit	= 0;	//0 = unlimited
+static size_t				memory_limit		= 0;	//0 = unlimited
+static size_t				connections			= 0;
+static size_t				memory_used			= 0;
+
+/*------------------------------------------------------------------------*/
+void admission_init(size_t max_connections, size_t memory_budget)
+{
+	connection_limit 	= max_connections;
+	memory_limit 		= memory_budget;
+}
+/*------------------------------------------------------------------------*/
+int admission_connection_open(void)
+{
+	size_t active;
+
+	active = __atomic_add_fetch(&connections, 1, __ATOMIC_RELAXED);
+	if((connection_limit > 0) && (active > connection_limit))
+	{
+		__atomic_sub_fetch(&connections, 1, __ATOMIC_RELAXED);
+		return ERROR;
+	}
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+void admission_connection_close(void)
+{
+	__atomic_sub_fetch(&connections, 1, __ATOMIC_RELAXED);
+}
+/*------------------------------------------------------------------------*/
+size_t admission_connections(void)
+{
+	return __atomic_load_n(&connections, __ATOMIC_RELAXED);
+}
+/*------------------------------------------------------------------------*/
+int admission_charge(size_t bytes)
+{
+	size_t used;
+
+	used = __atomic_add_fetch(&memory_used, bytes, __ATOMIC_RELAXED);
+	if((memory_limit > 0) && (used > memory_limit))
+	{
+		__atomic_sub_fetch(&memory_used, bytes, __ATOMIC_RELAXED);
+		return ERROR;
+	}
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+void admission_release(size_t bytes)
+{
+	__atomic_sub_fetch(&memory_used, bytes, __ATOMIC_RELAXED);
+}
+/*------------------------------------------------------------------------*/
+size_t admission_memory_used(void)
+{
+	return __atomic_load_n(&memory_used, __ATOMIC_RELAXED);
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
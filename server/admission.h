@@ -0,0 +1,95 @@
+/*
+ * @filename 		:	admission.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Admission control of aesdsocket. Caps the number
+ *						of concurrent connections (-m) and the memory
+ *						held in flight (-M): packet framer buffers and
+ *						packets waiting for the storage writer. A client
+ *						over the connection limit is closed right after
+ *						accept, a connection whose buffers would exceed
+ *						the budget is closed. Both are counted in the
+ *						statistics.
+ *
+ *						All functions are lock-free and may be called
+ *						from any thread.
+ */
+#ifndef ADMISSION_H_
+#define ADMISSION_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stddef.h>
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	sets the limits, 0 disables a limit
+ *
+ * @parameters	:	max_connections	:	concurrent connections allowed
+ *					memory_budget	:	bytes of buffers allowed in flight
+ *
+ * @returns		:	none
+ */
+void admission_init(size_t max_connections, size_t memory_budget);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	admits a new connection
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	SUCCESS if admitted, ERROR if the limit is reached
+ */
+int admission_connection_open(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	gives back the slot of an admitted connection
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void admission_connection_close(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	connections admitted and not closed yet
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	number of open connections
+ */
+size_t admission_connections(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	charges bytes against the memory budget
+ *
+ * @parameters	:	bytes	:	bytes about to be held
+ *
+ * @returns		:	SUCCESS if they fit, ERROR otherwise (nothing is
+ *					charged)
+ */
+int admission_charge(size_t bytes);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	returns bytes charged with admission_charge()
+ *
+ * @parameters	:	bytes	:	bytes no longer held
+ *
+ * @returns		:	none
+ */
+void admission_release(size_t bytes);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	bytes currently charged against the budget
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	memory in flight in bytes
+ */
+size_t admission_memory_used(void);
+
+#endif /* ADMISSION_H_ */
+/*EOF*/
@@ -0,0 +1,593 @@
+/*
+ * @filename 		:	aesdbench.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Loopback load generator for aesdsocket, built with
+ *						"make bench". Every connection runs in its own
+ *						thread and keeps one packet outstanding:
+ *
+ *							default	:	a new connection per packet, the
+ *										reply ends when the server closes
+ *							-k		:	one connection per client, the
+ *										server must run with -k too. A
+ *										reply ends with the packet just
+ *										sent, which is unique.
+ *
+ *						With -I (needs -k) every connection first sends
+ *						"AESD_SINCE:" with an offset past the end, so
+ *						replies only carry what was appended since the
+ *						previous reply on that connection.
+ *
+ *						With -r the packets of every connection are sent
+ *						on a fixed schedule and latency is measured from
+ *						the scheduled time, so a slow server is not
+ *						hidden by a slow sender.
+ *
+ *						A reply that does not complete within -t seconds
+ *						counts as an error, e.g. a server running with -k
+ *						never closes the connection a reply waits for
+ *						without -k.
+ *
+ *						Example:
+ *							./aesdbench -c 16 -n 1000 -s 128 -k
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define ERROR				(-1)
+#define SUCCESS				(0)
+
+#define DEFAULT_HOST		"localhost"
+#define DEFAULT_PORT		"9000"
+#define DEFAULT_CONNECTIONS	(1)
+#define DEFAULT_PACKETS		(100)
+#define DEFAULT_SIZE		(64)
+#define MIN_SIZE			(24)		//room for the unique packet header
+#define RECV_SIZE			(64 * 1024)
+#define DEFAULT_TIMEOUT		(10.0)		//seconds a reply may take
+#define THREAD_STACK_SIZE	(256 * 1024)
+
+//offset past any history, the server replies from its current end
+#define SINCE_NOW			"AESD_SINCE:18446744073709551615\n"
+
+/*------------------------------------------------------------------------*/
+/*							BENCH STRUCTURES							  */
+/*------------------------------------------------------------------------*/
+struct bench_config
+{
+	const char *host;
+	const char *port;
+	int connections;
+	long packets;				//per connection
+	size_t size;				//packet size including the newline
+	double rate;				//packets per second per connection, 0 = closed loop
+	double timeout;				//seconds without reply data, 0 = wait forever
+	bool sessions;
+	bool incremental;			//replies only carry new history
+};
+
+struct bench_client
+{
+	pthread_t thread_id;
+	int id;
+	uint64_t *latencies;		//nanoseconds, one per completed packet
+	long completed;
+	uint64_t reply_bytes;
+	uint64_t max_reply;
+	long errors;
+};
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static struct bench_config config =
+{
+	.host 			= DEFAULT_HOST,
+	.port 			= DEFAULT_PORT,
+	.connections 	= DEFAULT_CONNECTIONS,
+	.packets 		= DEFAULT_PACKETS,
+	.size 			= DEFAULT_SIZE,
+	.rate 			= 0,
+	.timeout 		= DEFAULT_TIMEOUT,
+	.sessions 		= false,
+	.incremental 	= false,
+};
+
+static struct addrinfo *server_address = NULL;
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	parses the command line into config
+ *
+ * @parameters	:	argc, argv	:	arguments passed to main()
+ *
+ * @returns		:	none, exits with EXIT_FAILURE on invalid arguments
+ */
+static void parse_arguments(int argc, char *argv[]);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	sends config.packets packets on behalf of one client
+ *
+ * @parameters	:	arg	:	struct bench_client of the thread
+ *
+ * @returns		:	NULL
+ */
+static void* bench_client_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	opens a TCP connection to the server
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	connected socket, ERROR on failure
+ */
+static int bench_connect(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	sends one packet and receives its reply
+ *
+ * @parameters	:	sockfd	:	connected socket
+ *					packet	:	packet to send, unique in the history
+ *					buffer	:	RECV_SIZE receive buffer
+ *					tail	:	config.size bytes holding the end of
+ *								the reply received so far
+ *
+ * @returns		:	reply length in bytes, ERROR on failure
+ */
+static ssize_t bench_exchange(int sockfd, const char *packet, char *buffer, char *tail);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	monotonic clock in nanoseconds
+ */
+static uint64_t bench_now(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	qsort() comparison of two latencies
+ */
+static int compare_latency(const void *a, const void *b);
+
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		:	Application entry point
+ *					Runs every client, then prints throughput, latency
+ *					percentiles and reply sizes.
+ */
+/*------------------------------------------------------------------------*/
+int main(int argc, char *argv[])
+{
+	struct bench_client *clients;
+	struct addrinfo hints;
+	pthread_attr_t attr;
+	uint64_t *latencies, start, elapsed, reply_bytes = 0, max_reply = 0;
+	long completed = 0, errors = 0, i, j;
+	int status;
+
+	parse_arguments(argc, argv);
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family 	= AF_UNSPEC;
+	hints.ai_socktype 	= SOCK_STREAM;
+	status = getaddrinfo(config.host, config.port, &hints, &server_address);
+	if(status != SUCCESS)
+	{
+		fprintf(stderr, "getaddrinfo() failed: %s\n", gai_strerror(status));
+		exit(EXIT_FAILURE);
+	}
+
+	clients = (struct bench_client *) calloc(config.connections, sizeof(struct bench_client));
+	if(clients == NULL)
+	{
+		fprintf(stderr, "calloc() failed\n");
+		exit(EXIT_FAILURE);
+	}
+	/*------------------------------------------------------------------------*/
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, THREAD_STACK_SIZE);
+
+	start = bench_now();
+	for(i = 0; i < config.connections; i++)
+	{
+		clients[i].id = i;
+		clients[i].latencies = (uint64_t *) calloc(config.packets, sizeof(uint64_t));
+		if(clients[i].latencies == NULL)
+		{
+			fprintf(stderr, "calloc() failed\n");
+			exit(EXIT_FAILURE);
+		}
+		status = pthread_create(&clients[i].thread_id, &attr, bench_client_thread, &clients[i]);
+		if(status != SUCCESS)
+		{
+			fprintf(stderr, "pthread_create() failed with error code: %d\n", status);
+			exit(EXIT_FAILURE);
+		}
+	}
+	for(i = 0; i < config.connections; i++)
+	{
+		pthread_join(clients[i].thread_id, NULL);
+	}
+	elapsed = bench_now() - start;
+	pthread_attr_destroy(&attr);
+	/*------------------------------------------------------------------------*/
+	for(i = 0; i < config.connections; i++)
+	{
+		completed 	+= clients[i].completed;
+		errors 		+= clients[i].errors;
+		reply_bytes += clients[i].reply_bytes;
+		if(clients[i].max_reply > max_reply)
+		{
+			max_reply = clients[i].max_reply;
+		}
+	}
+
+	latencies = (uint64_t *) malloc((completed > 0 ? completed : 1) * sizeof(uint64_t));
+	if(latencies == NULL)
+	{
+		fprintf(stderr, "malloc() failed\n");
+		exit(EXIT_FAILURE);
+	}
+	for(i = 0, completed = 0; i < config.connections; i++)
+	{
+		for(j = 0; j < clients[i].completed; j++)
+		{
+			latencies[completed++] = clients[i].latencies[j];
+		}
+		free(clients[i].latencies);
+	}
+	qsort(latencies, completed, sizeof(uint64_t), compare_latency);
+	/*------------------------------------------------------------------------*/
+	printf("connections %d packets %ld size %zu rate %.1f/s mode %s\n",
+			config.connections, config.packets, config.size, config.rate,
+			config.incremental ? "session-incremental" :
+			(config.sessions ? "session" : "connection-per-packet"));
+	printf("elapsed %.3f s throughput %.1f packets/s errors %ld\n",
+			elapsed / 1e9, completed / (elapsed / 1e9), errors);
+	if(completed > 0)
+	{
+		printf("latency_us p50 %.1f p99 %.1f p999 %.1f max %.1f\n",
+				latencies[(completed - 1) / 2] / 1e3,
+				latencies[(completed * 99 - 1) / 100] / 1e3,
+				latencies[(completed * 999 - 1) / 1000] / 1e3,
+				latencies[completed - 1] / 1e3);
+		printf("reply_bytes mean %.1f max %llu total %llu\n",
+				(double) reply_bytes / completed, (unsigned long long) max_reply,
+				(unsigned long long) reply_bytes);
+	}
+
+	free(latencies);
+	free(clients);
+	freeaddrinfo(server_address);
+	return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*------------------------------------------------------------------------*/
+static void parse_arguments(int argc, char *argv[])
+{
+	int option;
+	char *end;
+
+	while((option = getopt(argc, argv, "H:p:c:n:s:r:t:kI")) != ERROR)
+	{
+		switch(option)
+		{
+			case 'H':
+				config.host = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'p':
+				config.port = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'c':
+				config.connections = (int) strtol(optarg, &end, 10);
+				if((*end != '\0') || (config.connections <= 0))
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'n':
+				config.packets = strtol(optarg, &end, 10);
+				if((*end != '\0') || (config.packets <= 0))
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 's':
+				config.size = (size_t) strtoul(optarg, &end, 10);
+				if((*end != '\0') || (config.size < MIN_SIZE))
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'r':
+				config.rate = strtod(optarg, &end);
+				if((*end != '\0') || (config.rate < 0))
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 't':
+				config.timeout = strtod(optarg, &end);
+				if((*end != '\0') || (config.timeout < 0))
+				{
+					goto usage;
+				}
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'k':
+				config.sessions = true;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'I':
+				config.incremental = true;
+				break;
+			/*------------------------------------------------------------------------*/
+			default:
+				goto usage;
+		}
+	}
+	if(config.incremental && !config.sessions)
+	{
+		goto usage;
+	}
+	return;
+
+usage:
+	fprintf(stderr, "Usage: %s [-H host] [-p port] [-c connections] [-n packets per connection]"
+					" [-s packet size >= %d] [-r packets/s per connection] [-t reply timeout seconds]"
+					" [-k [-I]]\n", argv[0], MIN_SIZE);
+	exit(EXIT_FAILURE);
+}
+/*------------------------------------------------------------------------*/
+static void* bench_client_thread(void *arg)
+{
+	struct bench_client *client = (struct bench_client *) arg;
+	char *packet, *buffer, *tail;
+	uint64_t scheduled, now, interval;
+	struct timespec delay;
+	ssize_t reply;
+	int sockfd = ERROR, header;
+	long seq;
+
+	packet = (char *) malloc(config.size);
+	buffer = (char *) malloc(RECV_SIZE);
+	tail = (char *) malloc(config.size);
+	if((packet == NULL) || (buffer == NULL) || (tail == NULL))
+	{
+		fprintf(stderr, "malloc() failed\n");
+		client->errors = config.packets;
+		goto cleanup;
+	}
+
+	interval = (config.rate > 0) ? (uint64_t) (1e9 / config.rate) : 0;
+	scheduled = bench_now();
+	/*------------------------------------------------------------------------*/
+	for(seq = 0; seq < config.packets; seq++)
+	{
+		//a header unique across the run makes the end of a reply unambiguous
+		memset(packet, 'x', config.size);
+		header = snprintf(packet, config.size, "c%d s%ld %llx ", client->id, seq,
+							(unsigned long long) scheduled);
+		packet[header] = 'x';
+		packet[config.size - 1] = '\n';
+
+		if(interval > 0)
+		{
+			now = bench_now();
+			if(scheduled > now)
+			{
+				delay.tv_sec 	= (scheduled - now) / 1000000000ULL;
+				delay.tv_nsec 	= (scheduled - now) % 1000000000ULL;
+				nanosleep(&delay, NULL);
+			}
+		}
+		else
+		{
+			scheduled = bench_now();
+		}
+		/*------------------------------------------------------------------------*/
+		if(sockfd == ERROR)
+		{
+			sockfd = bench_connect();
+			if(sockfd == ERROR)
+			{
+				client->errors++;
+				scheduled += interval;
+				continue;
+			}
+		}
+
+		reply = bench_exchange(sockfd, packet, buffer, tail);
+		if(reply == ERROR)
+		{
+			client->errors++;
+			close(sockfd);
+			sockfd = ERROR;
+		}
+		else
+		{
+			client->latencies[client->completed++] = bench_now() - scheduled;
+			client->reply_bytes += reply;
+			if((uint64_t) reply > client->max_reply)
+			{
+				client->max_reply = reply;
+			}
+			if(!config.sessions)
+			{
+				close(sockfd);
+				sockfd = ERROR;
+			}
+		}
+		scheduled += interval;
+	}
+
+cleanup:
+	if(sockfd != ERROR)
+	{
+		close(sockfd);
+	}
+	free(packet);
+	free(buffer);
+	free(tail);
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static int bench_connect(void)
+{
+	struct timeval timeout;
+	int sockfd;
+
+	sockfd = socket(server_address->ai_family, server_address->ai_socktype, server_address->ai_protocol);
+	if(sockfd == ERROR)
+	{
+		fprintf(stderr, "socket() failed: %s\n", strerror(errno));
+		return ERROR;
+	}
+	if(connect(sockfd, server_address->ai_addr, server_address->ai_addrlen) == ERROR)
+	{
+		fprintf(stderr, "connect() failed: %s\n", strerror(errno));
+		close(sockfd);
+		return ERROR;
+	}
+	//packets are small and latency bound
+	setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &(int){1}, sizeof(int));
+
+	//a reply that stalls fails the recv() instead of hanging the client
+	if(config.timeout > 0)
+	{
+		timeout.tv_sec 	= (time_t) config.timeout;
+		timeout.tv_usec = (suseconds_t) ((config.timeout - timeout.tv_sec) * 1e6);
+		if(setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == ERROR)
+		{
+			fprintf(stderr, "setsockopt() failed: %s\n", strerror(errno));
+			close(sockfd);
+			return ERROR;
+		}
+	}
+
+	//the command is answered with an empty reply, nothing to wait for
+	if(config.incremental &&
+		(send(sockfd, SINCE_NOW, strlen(SINCE_NOW), MSG_NOSIGNAL) != (ssize_t) strlen(SINCE_NOW)))
+	{
+		fprintf(stderr, "send() failed: %s\n", strerror(errno));
+		close(sockfd);
+		return ERROR;
+	}
+	return sockfd;
+}
+/*------------------------------------------------------------------------*/
+static ssize_t bench_exchange(int sockfd, const char *packet, char *buffer, char *tail)
+{
+	size_t sent = 0, received = 0, keep;
+	ssize_t status;
+
+	while(sent < config.size)
+	{
+		status = send(sockfd, packet + sent, config.size - sent, MSG_NOSIGNAL);
+		if(status == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			fprintf(stderr, "send() failed: %s\n", strerror(errno));
+			return ERROR;
+		}
+		sent += status;
+	}
+	/*------------------------------------------------------------------------*/
+	while(true)
+	{
+		status = recv(sockfd, buffer, RECV_SIZE, 0);
+		if(status == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			{
+				fprintf(stderr, "no reply within %.1f s%s\n", config.timeout,
+						config.sessions ? "" : ", is the server running with -k?");
+				return ERROR;
+			}
+			fprintf(stderr, "recv() failed: %s\n", strerror(errno));
+			return ERROR;
+		}
+		if(status == 0)
+		{
+			//the server closes after the reply unless sessions are used
+			if(config.sessions)
+			{
+				fprintf(stderr, "connection closed, is the server running with -k?\n");
+				return ERROR;
+			}
+			break;
+		}
+		received += status;
+		if(!config.sessions)
+		{
+			continue;
+		}
+		/*------------------------------------------------------------------------*/
+		//keep the last config.size bytes of the reply
+		if((size_t) status >= config.size)
+		{
+			memcpy(tail, buffer + status - config.size, config.size);
+		}
+		else
+		{
+			keep = config.size - status;
+			memmove(tail, tail + status, keep);
+			memcpy(tail + keep, buffer, status);
+		}
+		if((received >= config.size) && !memcmp(tail, packet, config.size))
+		{
+			break;
+		}
+	}
+
+	return (ssize_t) received;
+}
+/*------------------------------------------------------------------------*/
+static uint64_t bench_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+/*------------------------------------------------------------------------*/
+static int compare_latency(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *) a;
+	uint64_t y = *(const uint64_t *) b;
+
+	return (x > y) - (x < y);
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
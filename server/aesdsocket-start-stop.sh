@@ -7,11 +7,21 @@
 #
 # @date	: Feb 20, 2022
 #
+# upgrade replaces a running aesdsocket without refusing clients, the new
+# one takes the listening socket and the history over the handoff socket
+#
+
+HANDOFF=/var/run/aesdsocket.handoff
 
 case "$1" in
     start)	
         echo "Starting aesdsocket"
-        start-stop-daemon -S -n aesdsocket -a /usr/bin/aesdsocket -- -d
+        start-stop-daemon -S -n aesdsocket -a /usr/bin/aesdsocket -- -d -H $HANDOFF
+        ;;
+        
+    upgrade)
+        echo "Upgrading aesdsocket"
+        /usr/bin/aesdsocket -d -H $HANDOFF
         ;;
         
     stop)
@@ -20,7 +30,7 @@ case "$1" in
         ;;
         
     *)
-        echo "Usage: $0 {start|stop}" 
+        echo "Usage: $0 {start|stop|upgrade}" 
         exit 1 
 esac
 
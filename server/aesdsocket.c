@@ -9,6 +9,21 @@
 						
 						Updated on Mar 13, 2022
 						Changes for Assignment 8
+
+						Updated on Oct 17, 2026
+						Connections are serviced by the epoll event
+						loops in event-loop.c, timestamps are written by
+						the timerfd thread in timestamp-writer.c and
+						clients are accepted by the acceptors in
+						acceptor.c. Request path messages are logged
+						through async-log.c.
+
+						Signals are read from a signalfd by the main
+						thread instead of a handler: SIGINT stops at
+						once, SIGTERM lets open connections finish for
+						up to -G seconds. With -H the server takes over
+						from a running one and can be replaced the same
+						way, see handoff.h.
  */
 /*------------------------------------------------------------------------*/
 /*								LIBRARY FILES							  */
@@ -26,11 +41,24 @@
 #include <stdarg.h>
 #include <arpa/inet.h>
 #include <signal.h>
+#include <poll.h>
+#include <sys/signalfd.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <pthread.h>
-#include <sys/queue.h>
-#include <sys/time.h>
+
+#include "aesdsocket.h"
+#include "event-loop.h"
+#include "storage-backend.h"
+#include "storage-writer.h"
+#include "timestamp-writer.h"
+#include "server-stats.h"
+#include "admin-socket.h"
+#include "acceptor.h"
+#include "admission.h"
+#include "async-log.h"
+#include "handoff.h"
 /*------------------------------------------------------------------------*/
 /*								MACROS									  */
 /*------------------------------------------------------------------------*/
@@ -44,54 +72,54 @@
 #define NOCHDIR 			(0)
 #define NOCLOSE 			(0)
 
-#define FILE_PERMISSIONS 	(0644)
-#define BUFFER_SIZE			(1024)
-#define LISTEN_BACKLOG		(5)
-
-#define DEBUG				(0) 	//set this to 1 to enable printfs for debug
-#define ERROR				(-1)
-#define SUCCESS				(0)
+#define DEFAULT_BACKLOG		(SOMAXCONN)	//the kernel caps it at net.core.somaxconn
 
-//For Assignment 8.
-#define USE_AESD_CHAR_DEVICE	(1)
-#if (USE_AESD_CHAR_DEVICE == 1)
-	#define STORAGE_PATH  	"/dev/aesdchar";
-#else
-	#define STORAGE_PATH 	"/var/tmp/aesdsocketdata"
-#endif
+#define DEFAULT_WORKERS		(0)		//one worker per online cpu
+#define DEFAULT_ACCEPTORS	(1)
+#define DEFAULT_QUEUE_DEPTH	(128)
 
-/*------------------------------------------------------------------------*/
-/*				GLOBAL STRUCTURES FOR THREAD & SOCKET HANDLING			  */
-/*------------------------------------------------------------------------*/
-typedef struct
-{
-	bool thread_complete;
-	pthread_t thread_id;
-	int clifd;
-	pthread_mutex_t *mutex;
-}thread_parameters;
-
-struct slist_data_s
-{
-	thread_parameters	thread_params;
-	SLIST_ENTRY(slist_data_s) entries;
-};
+#define DEFAULT_TIMESTAMP_INTERVAL	(10)	//seconds, 0 disables timestamps
+#define DEFAULT_TIMESTAMP_FORMAT	"timestamp:%d.%b.%y - %k:%M:%S"
 
-typedef struct slist_data_s slist_data_t;
-pthread_mutex_t mutex_lock = PTHREAD_MUTEX_INITIALIZER;
-SLIST_HEAD(slisthead, slist_data_s) head;
+#define DEFAULT_DRAIN_SECONDS	(5)		//SIGTERM and handoff, 0 stops at once
 
 /*------------------------------------------------------------------------*/
 /*							GLOBAL VARIABLES							  */
 /*------------------------------------------------------------------------*/
-int 			fd 				= 0;		//file descriptor
-int 			sockfd 			= 0;		//socket file descriptor
-int 			clientfd 		= 0;		//client file descriptor
+pthread_mutex_t mutex_lock 		= PTHREAD_MUTEX_INITIALIZER;
+
 int 			status 			= 0;		//variable for checking errors
-int 			packets 		= 0;		//size of packet received
-char 			byte 			= 0;		//variable for byte by byte transfer
-bool 			isdaemon		= false;	//boolean value to check for daemon
-slist_data_t 	*datap 			= NULL;		//node data pointer for linked list
+
+static int		signal_fd		= ERROR;	//SIGINT and SIGTERM, read by main
+
+struct aesdsocket_config config =
+{
+	.isdaemon 		= false,
+	.workers 		= DEFAULT_WORKERS,
+	.queue_depth 	= DEFAULT_QUEUE_DEPTH,
+	.cache 			= false,
+	.sessions 		= false,
+	.timestamp_interval	= DEFAULT_TIMESTAMP_INTERVAL,
+	.timestamp_format	= DEFAULT_TIMESTAMP_FORMAT,
+	.admin_path 	= NULL,
+	.backend 		= DEFAULT_BACKEND,
+	.storage_path 	= NULL,
+	.engine 		= "epoll",
+	.acceptors 		= DEFAULT_ACCEPTORS,
+	.pin_acceptors 	= false,
+	.max_connections	= 0,
+	.max_packet 	= 0,
+	.split_packets 	= false,
+	.memory_budget 	= 0,
+	.backlog 		= DEFAULT_BACKLOG,
+	.defer_accept 	= 0,
+	.retain_bytes 	= 0,
+	.retain_packets = 0,
+	.retain_seconds = 0,
+	.log_path 		= NULL,
+	.handoff_path 	= NULL,
+	.drain_seconds 	= DEFAULT_DRAIN_SECONDS,
+};
 
 /*------------------------------------------------------------------------*/
 /* 							FUNCTION PROTOTYPES	 						  */
@@ -107,38 +135,39 @@ slist_data_t 	*datap 			= NULL;		//node data pointer for linked list
 static void handle_socket();
 /*------------------------------------------------------------------------*/
 /*
- * @brief		: 	handles reading data from file and sending to client
- *					via sockets using threads
+ * @brief		: 	parses the command line into config
  *
- * @parameters	:	none
+ * @parameters	:	argc, argv	:	arguments passed to main()
  *
- * @returns		:	pointer to thread parameters, exits with EXIT_FAILURE on 
- *					error
+ * @returns		:	none, exits with EXIT_FAILURE on invalid arguments
  */
-void* thread_handler(void* thread_params);
-#if (USE_AESD_CHAR_DEVICE == 0)
+static void parse_arguments(int argc, char *argv[]);
 /*------------------------------------------------------------------------*/
 /*
- * @brief		: 	handles the SIGALRM signal every time timer goes off
+ * @brief		: 	waits for a signal or a successor on the handoff
+ *					socket
  *
- * @parameters	:	none
+ * @parameters	:	handoff_fd	:	handoff socket, ERROR without -H
+ *					successor	:	set to the successor that took the
+ *									listeners, ERROR if there is none
  *
- * @returns		:	none, exits with EXIT_FAILURE on error
+ * @returns		:	true to drain the connections before stopping,
+ *					false to stop at once
  */
-static void sigalrm_handler();
-#endif
+static bool serve(int handoff_fd, int *successor);
 /*------------------------------------------------------------------------*/
 /*
- * @brief		: 	When a signal is caught during operation,
- * 					this function is called in response to
- *					the signal. Depending on the signal
- *					value, respective actons are taken.
+ * @brief		: 	stops every thread and closes the storage. A
+ *					successor gets the history once the connections
+ *					are drained.
  *
- * @parameters	:	signal_number	:	value of signal caught
+ * @parameters	:	drain		:	let open connections finish for up
+ *									to -G seconds
+ *					successor	:	successor from serve(), ERROR if none
  *
  * @returns		:	none
  */
-static void signal_handler(int signal_number);
+static void stop(bool drain, int successor);
 
 /*------------------------------------------------------------------------*/
 /*
@@ -150,46 +179,42 @@ static void signal_handler(int signal_number);
 /*------------------------------------------------------------------------*/
 int main(int argc, char *argv[])
 {
+	sigset_t signals;
+
 	openlog("aesdsocket",LOG_PID,LOG_USER);
 
-	//configure signals
-	if(signal(SIGINT, signal_handler)==SIG_ERR)
+	//configure signals, blocked before any thread exists and read from
+	//signal_fd by the main thread
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	if(pthread_sigmask(SIG_BLOCK, &signals, NULL) != SUCCESS)
 	{
-		syslog(LOG_ERR, "Failed to configure SIGINT handler\n");
+		syslog(LOG_ERR, "Failed to block SIGINT and SIGTERM\n");
 		#if DEBUG
-			printf("Failed to configure SIGINT handler\n");
+			printf("Failed to block SIGINT and SIGTERM\n");
 		#endif
 		exit(EXIT_FAILURE);
 	}
-	if(signal(SIGTERM, signal_handler)==SIG_ERR)
+	signal_fd = signalfd(-1, &signals, SFD_CLOEXEC);
+	if(signal_fd == ERROR)
 	{
-		syslog(LOG_ERR, "Failed to configure SIGTERM handler\n");
+		syslog(LOG_ERR, "signalfd() failed\n");
 		#if DEBUG
-			printf("Failed to configure SIGTERM handler\n");
+			printf("signalfd() failed\n");
 		#endif
 		exit(EXIT_FAILURE);
 	}
 
-	#if (USE_AESD_CHAR_DEVICE == 0)
-	if(signal(SIGALRM, sigalrm_handler)==SIG_ERR)
-	{
-		syslog(LOG_ERR, "Failed to configure SIGALRM handler\n");
-		#if DEBUG
-			printf("Failed to configure SIGALRM handler\n");
-		#endif
-		exit(EXIT_FAILURE);
-	}
-	#endif
+	//sendfile() has no MSG_NOSIGNAL, a client that resets mid-reply
+	//must fail the call with EPIPE instead of killing the server
+	signal(SIGPIPE, SIG_IGN);
 
 	pthread_mutex_init(&mutex_lock, NULL);
 
-	//check for daemon
-	if((argc >= 2) && (!strcmp("-d",(char*)argv[1])))
-	{
-		isdaemon = true;
-	}
+	parse_arguments(argc, argv);
 
-	//This function should never return
+	//This function should never return, it exits once stopped
 	//if it returns, an error has occured
 	handle_socket();
 
@@ -199,16 +224,257 @@ int main(int argc, char *argv[])
 	return ERROR;
 }
 /*------------------------------------------------------------------------*/
+static void parse_arguments(int argc, char *argv[])
+{
+	int option;
+	long value;
+	char *end;
+
+	while((option = getopt(argc, argv, "dt:q:cb:s:ki:f:a:e:A:Pm:p:o:M:B:D:R:N:T:l:L:H:G:")) != ERROR)
+	{
+		switch(option)
+		{
+			case 'd':
+				config.isdaemon = true;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 't':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0))
+				{
+					goto usage;
+				}
+				config.workers = (int) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'q':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value <= 0))
+				{
+					goto usage;
+				}
+				config.queue_depth = (size_t) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'c':
+				config.cache = true;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'b':
+				if(storage_find(optarg) == NULL)
+				{
+					goto usage;
+				}
+				config.backend = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 's':
+				config.storage_path = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'k':
+				config.sessions = true;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'i':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0))
+				{
+					goto usage;
+				}
+				config.timestamp_interval = (unsigned int) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'f':
+				if(*optarg == '\0')
+				{
+					goto usage;
+				}
+				config.timestamp_format = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'a':
+				config.admin_path = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'e':
+				if(strcmp(optarg, "epoll") && strcmp(optarg, "uring"))
+				{
+					goto usage;
+				}
+				config.engine = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'A':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value <= 0))
+				{
+					goto usage;
+				}
+				config.acceptors = (int) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'P':
+				config.pin_acceptors = true;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'm':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0))
+				{
+					goto usage;
+				}
+				config.max_connections = (size_t) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'p':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0))
+				{
+					goto usage;
+				}
+				config.max_packet = (size_t) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'o':
+				if(strcmp(optarg, "reject") && strcmp(optarg, "split"))
+				{
+					goto usage;
+				}
+				config.split_packets = (strcmp(optarg, "split") == 0);
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'M':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0))
+				{
+					goto usage;
+				}
+				config.memory_budget = (size_t) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'B':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value <= 0) || (value > INT_MAX))
+				{
+					goto usage;
+				}
+				config.backlog = (int) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'D':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0) || (value > INT_MAX))
+				{
+					goto usage;
+				}
+				config.defer_accept = (int) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'R':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0))
+				{
+					goto usage;
+				}
+				config.retain_bytes = (size_t) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'N':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0))
+				{
+					goto usage;
+				}
+				config.retain_packets = (size_t) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'T':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0) || (value > INT_MAX))
+				{
+					goto usage;
+				}
+				config.retain_seconds = (unsigned int) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'l':
+				value = async_log_parse_level(optarg);
+				if(value == ERROR)
+				{
+					goto usage;
+				}
+				async_log_set_level((int) value);
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'L':
+				config.log_path = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'H':
+				config.handoff_path = optarg;
+				break;
+			/*------------------------------------------------------------------------*/
+			case 'G':
+				value = strtol(optarg, &end, 10);
+				if((*end != '\0') || (value < 0))
+				{
+					goto usage;
+				}
+				config.drain_seconds = (unsigned int) value;
+				break;
+			/*------------------------------------------------------------------------*/
+			default:
+				goto usage;
+		}
+	}
+
+	//a handoff passes every listener in a single message
+	if((config.handoff_path != NULL) && (config.acceptors > HANDOFF_MAX_LISTENERS))
+	{
+		fprintf(stderr, "%s: at most %d acceptors with -H\n", argv[0], HANDOFF_MAX_LISTENERS);
+		exit(EXIT_FAILURE);
+	}
+	return;
+
+usage:
+	fprintf(stderr, "Usage: %s [-d] [-c] [-k] [-t workers] [-q queue depth]"
+					" [-b file|chardev|memory] [-s storage path]"
+					" [-i timestamp interval] [-f timestamp format]"
+					" [-a admin socket] [-e epoll|uring]"
+					" [-A acceptors] [-P] [-m max connections]"
+					" [-p max packet bytes] [-o reject|split]"
+					" [-M memory budget bytes] [-B listen backlog]"
+					" [-D defer accept seconds] [-R retained bytes]"
+					" [-N retained packets] [-T retained seconds]"
+					" [-l log level] [-L log file]"
+					" [-H handoff socket] [-G drain seconds]\n", argv[0]);
+	exit(EXIT_FAILURE);
+}
+/*------------------------------------------------------------------------*/
 static void handle_socket()
 {
 	struct addrinfo hints;
 	struct addrinfo *results;
-	struct sockaddr client_addr;
-	socklen_t client_addr_size;
-	char ip_address[INET_ADDRSTRLEN];
-	struct sockaddr_in *address;
-	struct itimerval timer;
-	SLIST_INIT(&head);
+	struct storage_retention retention;
+	int listeners[HANDOFF_MAX_LISTENERS];
+	int adopted = 0, handoff_fd = ERROR, successor;
+	char *history = NULL;
+	bool drain;
+	/*------------------------------------------------------------------------*/
+	//before daemon(), so an upgrade returns once the old server is gone
+	if(config.handoff_path != NULL)
+	{
+		adopted = handoff_request(config.handoff_path, listeners, HANDOFF_MAX_LISTENERS, &history);
+		if(adopted == ERROR)
+		{
+			syslog(LOG_ERR,"handoff_request() failed\n");
+			#if DEBUG
+				printf("handoff_request() failed\n");
+			#endif
+			exit(EXIT_FAILURE);
+		}
+	}
 	/*------------------------------------------------------------------------*/
 	memset(&hints,0,sizeof(hints));
 	hints.ai_flags 		= SOCKET_FLAGS;
@@ -224,40 +490,18 @@ static void handle_socket()
 		exit(EXIT_FAILURE);
 	}
 	/*------------------------------------------------------------------------*/ 
-	sockfd = socket(PF_INET6, SOCK_STREAM, 0);
-	if(sockfd == ERROR)
-	{
-		syslog(LOG_ERR,"socket() failed\n");
-		#if DEBUG
-			printf("socket() failed\n");
-		#endif
-		freeaddrinfo(results);
-		exit(EXIT_FAILURE);
-	}
-	/*------------------------------------------------------------------------*/ 
-	status = setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int));
-	if(status == ERROR)
-	{
-		syslog(LOG_ERR,"setsockopt() failed\n");
-		#if DEBUG
-			printf("setsockopt() failed\n");
-		#endif
-		freeaddrinfo(results);
-		exit(EXIT_FAILURE);
-	}
-	/*------------------------------------------------------------------------*/ 
-	status = bind(sockfd, results->ai_addr, results->ai_addrlen);
+	status = (adopted > 0) ? acceptor_adopt(listeners, adopted) : acceptor_open(results, config.acceptors);
 	if(status == ERROR)
 	{
-		syslog(LOG_ERR,"bind() failed\n");
+		syslog(LOG_ERR,"acceptor_open() failed\n");
 		#if DEBUG
-			printf("bind() failed\n");
+			printf("acceptor_open() failed\n");
 		#endif
 		freeaddrinfo(results);
 		exit(EXIT_FAILURE);
 	}
 	/*------------------------------------------------------------------------*/ 
-	if (isdaemon)
+	if (config.isdaemon)
 	{
 		//change the process' current working directory
 		//to root directory & redirect STDIN, STDOUT, 
@@ -277,405 +521,220 @@ static void handle_socket()
 		#endif
 	}
 	/*------------------------------------------------------------------------*/ 
-	fd = creat(STORAGE_PATH, FILE_PERMISSIONS);
-	if(fd == ERROR)
+	//after daemon(), the flusher thread would not survive the fork
+	status = async_log_start(config.log_path);
+	if(status == ERROR)
 	{
-		syslog(LOG_ERR,"creat() failed\n");
+		syslog(LOG_ERR,"async_log_start() failed\n");
 		#if DEBUG
-			printf("creat() failed\n");
+			printf("async_log_start() failed\n");
 		#endif
 		exit(EXIT_FAILURE);
 	}
-	close(fd);
-	freeaddrinfo(results);
-	/*------------------------------------------------------------------------*/ 
-	//configure timer
-	timer.it_interval.tv_sec 	= 10; //timer interval of 10 secs
-	timer.it_interval.tv_usec 	= 0;
-	timer.it_value.tv_sec 		= 10; //time expiration of 10 secs
-	timer.it_value.tv_usec 		= 0;
-	status = setitimer(ITIMER_REAL, &timer, NULL);
+
+	retention.max_bytes 	= config.retain_bytes;
+	retention.max_packets 	= config.retain_packets;
+	retention.max_age 		= (time_t) config.retain_seconds;
+	status = storage_open(storage_find(config.backend), config.storage_path, config.cache,
+							&retention, history);
+	free(history);
 	if(status == ERROR)
 	{
-		syslog(LOG_ERR,"setitimer() failed\n");
+		syslog(LOG_ERR,"storage_open() failed\n");
 		#if DEBUG
-			printf("setitimer() failed\n");
+			printf("storage_open() failed\n");
 		#endif
+		exit(EXIT_FAILURE);
 	}
-	/*------------------------------------------------------------------------*/
-	while(true)
-	{
-		status = listen(sockfd, LISTEN_BACKLOG);
-		if(status == ERROR)
-		{
-			syslog(LOG_ERR,"listen() failed\n");
-			#if DEBUG
-				printf("listen() failed\n");
-			#endif
-			freeaddrinfo(results);
-			exit(EXIT_FAILURE);
-		}
-		/*------------------------------------------------------------------------*/
-		client_addr_size = sizeof(struct sockaddr);
-		clientfd = accept(sockfd,(struct sockaddr *)&client_addr, &client_addr_size);
-		if(clientfd == ERROR)
-		{
-			syslog(LOG_ERR,"accept() failed\n");
-			#if DEBUG
-				printf("accept() failed\n");
-			#endif
-			freeaddrinfo(results);
-			exit(EXIT_FAILURE);
-		}
-		address = (struct sockaddr_in *)&client_addr;
-		inet_ntop(AF_INET, &(address->sin_addr),ip_address,INET_ADDRSTRLEN);
-		syslog(LOG_INFO,"Accepting connection from %s",ip_address);
-		#if DEBUG
-			printf("Accepting connection from %s",ip_address);
-		#endif
-		/*------------------------------------------------------------------------*/
-		datap = (slist_data_t *) malloc(sizeof(slist_data_t));
-		SLIST_INSERT_HEAD(&head,datap,entries);
-
-		datap->thread_params.clifd 				= clientfd;
-		datap->thread_params.thread_complete 	= false;
-		datap->thread_params.mutex 				= &mutex_lock;
-
-		status = pthread_create(&(datap->thread_params.thread_id), 			
-							NULL,			
-							thread_handler,			
-							&datap->thread_params
-							);
-
-		if (status != SUCCESS)
-		{
-			syslog(LOG_ERR,"pthread_create() failed\n");
-			#if DEBUG
-				printf("pthread_create() failed\n");
-			#endif
-			exit(EXIT_FAILURE);
-		}
-
-		syslog(LOG_INFO,"Thread created\n");
-		#if DEBUG
-			printf("Thread created\n");
-		#endif
-
-		SLIST_FOREACH(datap,&head,entries)
-		{
-			pthread_join(datap->thread_params.thread_id,NULL);
-			if(datap->thread_params.thread_complete == true)
-			{
-				//pthread_join(datap->thread_params.thread_id,NULL);
-				SLIST_REMOVE(&head, datap, slist_data_s, entries);
-				free(datap);
-				break;
-			}
-		}
-		syslog(LOG_INFO,"Thread exited\n");
-		#if DEBUG
-			printf("Thread exited\n");
-		#endif
-
-		syslog(LOG_DEBUG,"Closed connection from %s",ip_address);
-		#if DEBUG
-			printf("Closed connection from %s",ip_address);
-		#endif
-		/*------------------------------------------------------------------------*/
-	}
-	close(clientfd);
-	close(sockfd);
-}
+	freeaddrinfo(results);
 
-/*------------------------------------------------------------------------*/
-void* thread_handler(void* thread_params)
-{
-	bool packet_rcvd = false;
-	int i;
-	char read_data[BUFFER_SIZE] = {0};
-	char *buffer = NULL;
-	thread_parameters * parameters = (thread_parameters *) thread_params;
-	/*------------------------------------------------------------------------*/
-	buffer = (char *) malloc(sizeof(char)*BUFFER_SIZE);
-	if(buffer == NULL)
+	status = storage_writer_start();
+	if(status == ERROR)
 	{
-		syslog(LOG_ERR,"malloc() failed");
+		syslog(LOG_ERR,"storage_writer_start() failed\n");
 		#if DEBUG
-			printf("malloc() failed");
+			printf("storage_writer_start() failed\n");
 		#endif
 		exit(EXIT_FAILURE);
 	}
-
-	memset(buffer,0,BUFFER_SIZE);
-	/*------------------------------------------------------------------------*/
-	while(!packet_rcvd)
+	/*------------------------------------------------------------------------*/ 
+	//the char device does not take timestamps
+	if(storage_wants_timestamps() && (config.timestamp_interval > 0))
 	{
-		status = recv(parameters->clifd, read_data, BUFFER_SIZE ,0); 
+		status = timestamp_writer_start(config.timestamp_interval, config.timestamp_format);
 		if(status == ERROR)
 		{
-			syslog(LOG_ERR,"recv() failed");
+			syslog(LOG_ERR,"timestamp_writer_start() failed\n");
 			#if DEBUG
-				printf("recv() failed");
+				printf("timestamp_writer_start() failed\n");
 			#endif
 			exit(EXIT_FAILURE);
 		}
-		/*------------------------------------------------------------------------*/
-		for(i = 0;i < BUFFER_SIZE;i++)
-		{
-			if(read_data[i] == '\n')
-			{
-				packet_rcvd = true;
-				i++;
-				break;
-			}
-		}
-		packets += i;
-		/*------------------------------------------------------------------------*/
-		buffer = (char *) realloc(buffer,(ssize_t)(packets+1));
-		if(buffer == NULL)
-		{
-			syslog(LOG_ERR,"realloc() failed");
-			#if DEBUG
-				printf("recv() failed");
-			#endif
-			exit(EXIT_FAILURE);
-		}
-		strncat(buffer,read_data,i);
-		memset(read_data,0,BUFFER_SIZE);
-	}
-	/*------------------------------------------------------------------------*/
-	status = pthread_mutex_lock(parameters->mutex);
-	if(status != SUCCESS)
-	{
-		syslog(LOG_ERR,"pthread_mutex_lock() failed with error code: %d\n",status);
-		#if DEBUG
-			printf("pthread_mutex_lock() failed with error code: %d\n",status);
-		#endif
-		exit(EXIT_FAILURE);
 	}
 	/*------------------------------------------------------------------------*/
-	fd = open(STORAGE_PATH,O_APPEND | O_WRONLY);
-	if(fd == ERROR)
-	{
-		syslog(LOG_ERR,"open() failed (append and write only)\n");
-		#if DEBUG
-			printf("open() failed (append and write only)\n");
-		#endif
-		exit(EXIT_FAILURE);
-	}
-	/*------------------------------------------------------------------------*/
-	int status = write(fd,buffer,strlen(buffer));
+	status = acceptor_listen(config.backlog, config.defer_accept);
 	if(status == ERROR)
 	{
-		syslog(LOG_ERR,"write() failed\n");
+		syslog(LOG_ERR,"acceptor_listen() failed\n");
 		#if DEBUG
-			printf("write() failed\n");
+			printf("acceptor_listen() failed\n");
 		#endif
 		exit(EXIT_FAILURE);
 	}
-	else if(status != strlen(buffer))
-	{
-		syslog(LOG_ERR,"File partially written\n");
-		#if DEBUG
-			printf("File partially written\n");
-		#endif
-		exit(EXIT_FAILURE);
-	}
-	close(fd);
 	/*------------------------------------------------------------------------*/
-	memset(read_data,0,BUFFER_SIZE);
-	fd = open(STORAGE_PATH,O_RDONLY);
-	if(fd == ERROR)
+	admission_init(config.max_connections, config.memory_budget);
+	status = event_loop_start(config.workers, config.queue_depth,
+								strcmp(config.engine, "uring") == 0);
+	if(status == ERROR)
 	{
-		syslog(LOG_ERR,"open() failed (read only)\n");
+		syslog(LOG_ERR,"event_loop_start() failed\n");
 		#if DEBUG
-			printf("open() failed (read only)\n");
+			printf("event_loop_start() failed\n");
 		#endif
 		exit(EXIT_FAILURE);
 	}
 	/*------------------------------------------------------------------------*/
-	for(i=0;i<packets;i++)
+	if(config.admin_path != NULL)
 	{
-		status = read(fd, &byte, 1);
-		if(status == ERROR)
-		{
-			syslog(LOG_ERR,"read() failed!\n");
-			#if DEBUG
-				printf("read() failed!\n");
-			#endif
-			exit(EXIT_FAILURE);
-		}
-		/*------------------------------------------------------------------------*/
-		status = send(parameters->clifd,&byte,1,0);
+		status = admin_socket_start(config.admin_path);
 		if(status == ERROR)
 		{
-			syslog(LOG_ERR,"send() failed!\n");
+			syslog(LOG_ERR,"admin_socket_start() failed\n");
 			#if DEBUG
-				printf("send() failed!\n");
+				printf("admin_socket_start() failed\n");
 			#endif
 			exit(EXIT_FAILURE);
 		}
 	}
 	/*------------------------------------------------------------------------*/
-	status = pthread_mutex_unlock(parameters->mutex);
-	if(status!=SUCCESS)
+	status = acceptor_start(config.pin_acceptors);
+	if(status == ERROR)
 	{
-		syslog(LOG_ERR,"pthread_mutex_unlock() failed with error code: %d\n",status);
+		syslog(LOG_ERR,"acceptor_start() failed\n");
 		#if DEBUG
-			printf("pthread_mutex_unlock() failed with error code: %d\n",status);
+			printf("acceptor_start() failed\n");
 		#endif
 		exit(EXIT_FAILURE);
 	}
 	/*------------------------------------------------------------------------*/
-	
-	parameters->thread_complete = true;
+	//last, a successor connecting from now on finds a server ready to stop
+	if(config.handoff_path != NULL)
+	{
+		handoff_fd = handoff_listen(config.handoff_path);
+		if(handoff_fd == ERROR)
+		{
+			syslog(LOG_ERR,"handoff_listen() failed\n");
+			#if DEBUG
+				printf("handoff_listen() failed\n");
+			#endif
+			exit(EXIT_FAILURE);
+		}
+	}
 
-	close(fd);
-	close(parameters->clifd);
-	free(buffer);
+	drain = serve(handoff_fd, &successor);
+	stop(drain, successor);
 
-	return parameters;
+	pthread_mutex_destroy(&mutex_lock);
+	closelog();
+	exit(EXIT_SUCCESS);
 }
 /*------------------------------------------------------------------------*/
-static void signal_handler(int signal_number)
+static bool serve(int handoff_fd, int *successor)
 {
-	switch(signal_number)
+	struct signalfd_siginfo info;
+	struct pollfd fds[2];
+	int listeners[HANDOFF_MAX_LISTENERS];
+	int count;
+
+	*successor 		= ERROR;
+	fds[0].fd 		= signal_fd;
+	fds[0].events 	= POLLIN;
+	fds[1].fd 		= handoff_fd;		//ignored by poll() while negative
+	fds[1].events 	= POLLIN;
+
+	while(true)
 	{
-		case SIGINT:
-			syslog(LOG_DEBUG,"SIGINT Caught! Exiting ... \n");
+		if(poll(fds, 2, -1) == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			syslog(LOG_ERR,"poll() failed\n");
 			#if DEBUG
-				printf("SIGINT Caught! Exiting ... \n");
+				printf("poll() failed\n");
 			#endif
-			
-			while(SLIST_FIRST(&head) != NULL)
+			return false;
+		}
+		/*------------------------------------------------------------------------*/
+		if((fds[0].revents & POLLIN) &&
+			(read(signal_fd, &info, sizeof(info)) == (ssize_t) sizeof(info)))
+		{
+			if(info.ssi_signo == SIGINT)
 			{
-				SLIST_FOREACH(datap,&head,entries)
-				{
-					close(datap->thread_params.clifd);
-					pthread_join(datap->thread_params.thread_id,NULL);
-					SLIST_REMOVE(&head, datap, slist_data_s, entries);
-					free(datap);
-					break;
-				}
+				syslog(LOG_DEBUG,"SIGINT Caught! Exiting ... \n");
+				#if DEBUG
+					printf("SIGINT Caught! Exiting ... \n");
+				#endif
+				return false;
 			}
 
-			pthread_mutex_destroy(&mutex_lock);
-			unlink(STORAGE_PATH);
-			close(clientfd);
-			close(sockfd);
-			break;
-		/*------------------------------------------------------------------------*/
-		case SIGTERM:
 			syslog(LOG_INFO,"SIGTERM Caught! Exiting ... \n");
 			#if DEBUG
 				printf("SIGTERM Caught! Exiting ... \n");
 			#endif
-
-			while(SLIST_FIRST(&head) != NULL)
+			return true;
+		}
+		/*------------------------------------------------------------------------*/
+		//a successor that failed to take the listeners is ignored
+		if(fds[1].revents & POLLIN)
+		{
+			count = acceptor_listeners(listeners, HANDOFF_MAX_LISTENERS);
+			*successor = handoff_accept(listeners, count);
+			if(*successor != ERROR)
 			{
-				SLIST_FOREACH(datap,&head,entries)
-				{
-					close(datap->thread_params.clifd);
-					pthread_join(datap->thread_params.thread_id,NULL);
-					SLIST_REMOVE(&head, datap, slist_data_s, entries);
-					free(datap);
-					break;
-				}
+				return true;
 			}
-			pthread_mutex_destroy(&mutex_lock);
-			unlink(STORAGE_PATH);
-			close(clientfd);
-			close(sockfd);
-			break;
-		/*------------------------------------------------------------------------*/
-		default:
-			exit(EXIT_FAILURE);
-			break;
+		}
 	}
-	exit(EXIT_SUCCESS);
 }
 /*------------------------------------------------------------------------*/
-
-#if (USE_AESD_CHAR_DEVICE==0)
-static void sigalrm_handler()
+static void stop(bool drain, int successor)
 {
-	char timestr[200];
-	time_t t;
-	struct tm *ptr;
-	int timer_length = 0;
-	/*------------------------------------------------------------------------*/
-	t = time(NULL);
-	ptr = localtime(&t);
-	if(ptr == NULL)
-	{
-		syslog(LOG_ERR,"localtime() failed\n");
-		#if DEBUG
-			printf("localtime() failed\n");				
-		#endif
-		exit(EXIT_FAILURE);
-	}
-	/*------------------------------------------------------------------------*/
+	char *history = NULL;
+
+	//the successor binds both paths once it got the history
+	admin_socket_stop();
+	handoff_close();
 
-	timer_length = strftime(timestr,sizeof(timestr),"timestamp:%d.%b.%y - %k:%M:%S\n",ptr);
-	if(timer_length == SUCCESS)
+	drain = drain && (config.drain_seconds > 0);
+	if(!drain)
 	{
-		syslog(LOG_ERR,"strftime() failed\n");
-		#if DEBUG
-			printf("strftime() failed\n");				
-		#endif
-		exit(EXIT_FAILURE);
+		event_loop_refuse();
 	}
-	/*------------------------------------------------------------------------*/
-	fd = open(STORAGE_PATH,O_APPEND | O_WRONLY);
-	if(fd == ERROR)
+	acceptor_stop();
+	if(drain)
 	{
-		syslog(LOG_ERR,"open() failed (append and write only)\n");
-		#if DEBUG
-			printf("open() failed (append and write only)\n");				
-		#endif
-		exit(EXIT_FAILURE);
+		event_loop_drain(config.drain_seconds);
 	}
+	//nothing is submitted once the loops are halted, the writer then
+	//commits everything queued before the loops take it back
+	timestamp_writer_stop();
+	event_loop_halt();
+	storage_writer_stop();
+	event_loop_stop();
 	/*------------------------------------------------------------------------*/
-	status = pthread_mutex_lock(&mutex_lock);
-	if(status != SUCCESS)
+	if(successor != ERROR)
 	{
-		syslog(LOG_ERR,"pthread_mutex_lock() failed with error code %d\n", status);
-		#if DEBUG
-			printf("pthread_mutex_lock() failed with error code %d\n", status);				
-		#endif
-		exit(EXIT_FAILURE);
+		history = storage_describe();
 	}
-	/*------------------------------------------------------------------------*/
-	status = write(fd,timestr,timer_length);
-	if(status == ERROR)
+	storage_close(history == NULL);
+	if(successor != ERROR)
 	{
-		syslog(LOG_ERR,"write() failed\n");
-		#if DEBUG
-			printf("write() failed\n");				
-		#endif
-		exit(EXIT_FAILURE);
-	}
-	else if(status != timer_length)
-	{
-		syslog(LOG_ERR,"file partially written\n");
-		#if DEBUG
-			printf("file partially written\n");				
-		#endif
-		exit(EXIT_FAILURE);
-	}
-	packets += timer_length;
-	/*------------------------------------------------------------------------*/
-	status = pthread_mutex_unlock(&mutex_lock);
-	if(status != SUCCESS)
-	{
-		syslog(LOG_ERR,"pthread_mutex_unlock() failed with error code %d\n", status);
-		#if DEBUG
-			printf("pthread_mutex_unlock() failed with error code %d\n", status);				
-		#endif
-		exit(EXIT_FAILURE);
+		handoff_finish(successor, history);
+		free(history);
 	}
-	close(fd);
+	async_log_stop();
 }
-#endif
 /*EOF*/
 /*------------------------------------------------------------------------*/
\ No newline at end of file
@@ -0,0 +1,88 @@
+/*
+ * @filename 		:	aesdsocket.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Macros and globals shared between the aesdsocket
+ *						translation units.
+ */
+#ifndef AESDSOCKET_H_
+#define AESDSOCKET_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define FILE_PERMISSIONS 	(0644)
+#define BUFFER_SIZE			(1024)
+
+#define DEBUG				(0) 	//set this to 1 to enable printfs for debug
+#define ERROR				(-1)
+#define SUCCESS				(0)
+
+#define AESD_CHAR_DEVICE_PATH	"/dev/aesdchar"
+#define AESD_DATA_FILE_PATH		"/var/tmp/aesdsocketdata"
+
+//control packet "AESD_SINCE:<byte offset>\n", never stored. From then on
+//the replies on that connection carry only history the client has not
+//seen yet instead of the full history.
+#define SINCE_COMMAND			"AESD_SINCE:"
+
+//For Assignment 8. Selects the default storage backend, -b overrides it
+//at runtime. Can be overridden from the command line of the build,
+//e.g. make CFLAGS+=-DUSE_AESD_CHAR_DEVICE=0
+#ifndef USE_AESD_CHAR_DEVICE
+	#define USE_AESD_CHAR_DEVICE	(1)
+#endif
+#if (USE_AESD_CHAR_DEVICE == 1)
+	#define DEFAULT_BACKEND  	"chardev"
+#else
+	#define DEFAULT_BACKEND 	"file"
+#endif
+
+/*------------------------------------------------------------------------*/
+/*							RUNTIME CONFIGURATION						  */
+/*------------------------------------------------------------------------*/
+//filled in from the command line by main()
+struct aesdsocket_config
+{
+	bool isdaemon;			//-d : run as a daemon
+	int workers;			//-t : worker threads, 0 = one per online cpu
+	size_t queue_depth;		//-q : accepted connections waiting for a worker
+	bool cache;				//-c : keep the history in memory for replies
+	bool sessions;			//-k : keep connections open, one reply per packet
+	unsigned int timestamp_interval;	//-i : seconds between timestamps, 0 = none
+	const char *timestamp_format;		//-f : strftime() format of a timestamp
+	const char *admin_path;		//-a : admin socket for STATS, NULL = none
+	const char *backend;	//-b : storage backend, file, chardev or memory
+	const char *storage_path;	//-s : storage path, NULL for the backend default
+	const char *engine;		//-e : connection engine, epoll or uring
+	int acceptors;			//-A : acceptor threads, one SO_REUSEPORT listener each
+	bool pin_acceptors;		//-P : pin acceptor i to cpu i
+	size_t max_connections;	//-m : concurrent connections, 0 = unlimited
+	size_t max_packet;		//-p : longest packet in bytes, 0 = unlimited
+	bool split_packets;		//-o : split (true) or reject (false) longer packets
+	size_t memory_budget;	//-M : bytes of buffers in flight, 0 = unlimited
+	int backlog;			//-B : listen() backlog of every listener
+	int defer_accept;		//-D : TCP_DEFER_ACCEPT seconds, 0 = off
+	size_t retain_bytes;	//-R : bytes of file history kept, 0 = all
+	size_t retain_packets;	//-N : packets of file history kept, 0 = all
+	unsigned int retain_seconds;	//-T : seconds of file history kept, 0 = all
+	const char *log_path;	//-L : log file, NULL = syslog
+	const char *handoff_path;	//-H : handoff socket, NULL = no handoff
+	unsigned int drain_seconds;	//-G : seconds connections may finish on stop
+};
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+extern pthread_mutex_t mutex_lock;		//serializes access to the storage backend
+extern struct aesdsocket_config config;
+
+#endif /* AESDSOCKET_H_ */
+/*EOF*/
@@ -0,0 +1,389 @@
+/*
+ * @filename 		:	async-log.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Per-thread log rings and their flusher thread.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <syslog.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include "aesdsocket.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+/*							RING STRUCTURES								  */
+/*------------------------------------------------------------------------*/
+struct log_record
+{
+	struct timespec time;
+	int priority;
+	char text[LOG_RECORD_SIZE];
+};
+
+//single producer (its thread), single consumer (the flusher)
+struct log_ring
+{
+	struct log_record records[LOG_RING_RECORDS];
+	unsigned int head;			//next record to flush, written by the flusher
+	unsigned int tail;			//next record to fill, written by the owner
+	uint64_t dropped;			//messages lost on a full ring
+	uint64_t reported;			//drops already logged, flusher only
+	struct log_ring *next;		//registered rings, never unlinked
+};
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+int 						async_log_threshold	= DEFAULT_LOG_LEVEL;
+
+static const char * const	level_names[] =
+{
+	"emerg", "alert", "crit", "err", "warning", "notice", "info", "debug",
+};
+
+static struct log_ring		*rings			= NULL;		//pushed with a CAS
+static __thread struct log_ring	*thread_ring	= NULL;
+static pthread_t			flusher_thread;
+static bool					log_running		= false;
+static bool					log_stopping	= false;
+static int					wake_fd			= ERROR;
+static FILE					*log_file		= NULL;		//NULL = syslog
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	flushes the rings every LOG_FLUSH_INTERVAL_MS or
+ *					when woken, until stopped
+ *
+ * @parameters	:	arg	:	unused
+ *
+ * @returns		:	NULL
+ */
+static void* async_log_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	writes out every record queued so far and reports
+ *					new drops
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+static void async_log_flush(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	writes one message to syslog or the log file
+ *
+ * @parameters	:	time		:	when the message was queued
+ *					priority	:	syslog priority
+ *					text		:	message without trailing newline
+ *
+ * @returns		:	none
+ */
+static void async_log_output(const struct timespec *time, int priority, const char *text);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	ring of the calling thread, registered on first use
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	the ring, NULL if it could not be allocated
+ */
+static struct log_ring* async_log_ring(void);
+
+/*------------------------------------------------------------------------*/
+int async_log_start(const char *path)
+{
+	sigset_t blocked, previous;
+	int status;
+
+	if(path != NULL)
+	{
+		log_file = fopen(path, "ae");
+		if(log_file == NULL)
+		{
+			syslog(LOG_ERR,"fopen() failed for %s\n", path);
+			#if DEBUG
+				printf("fopen() failed for %s\n", path);
+			#endif
+			return ERROR;
+		}
+	}
+
+	wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if(wake_fd == ERROR)
+	{
+		syslog(LOG_ERR,"eventfd() failed\n");
+		#if DEBUG
+			printf("eventfd() failed\n");
+		#endif
+		goto cleanup;
+	}
+	/*------------------------------------------------------------------------*/
+	log_stopping = false;
+	sigfillset(&blocked);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	status = pthread_create(&flusher_thread, NULL, async_log_thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	if(status != SUCCESS)
+	{
+		syslog(LOG_ERR,"pthread_create() failed with error code: %d\n",status);
+		#if DEBUG
+			printf("pthread_create() failed with error code: %d\n",status);
+		#endif
+		goto cleanup;
+	}
+	__atomic_store_n(&log_running, true, __ATOMIC_RELEASE);
+
+	syslog(LOG_INFO,"Logging to %s at level %s\n", (path != NULL) ? path : "syslog",
+			async_log_level_name(async_log_threshold));
+	return SUCCESS;
+
+cleanup:
+	if(wake_fd != ERROR)
+	{
+		close(wake_fd);
+		wake_fd = ERROR;
+	}
+	if(log_file != NULL)
+	{
+		fclose(log_file);
+		log_file = NULL;
+	}
+	return ERROR;
+}
+/*------------------------------------------------------------------------*/
+void async_log_stop(void)
+{
+	struct log_ring *ring;
+
+	if(!log_running)
+	{
+		return;
+	}
+
+	//late messages go straight to syslog, the flusher drains the rest
+	__atomic_store_n(&log_running, false, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&log_stopping, true, __ATOMIC_SEQ_CST);
+	eventfd_write(wake_fd, 1);
+	pthread_join(flusher_thread, NULL);
+
+	close(wake_fd);
+	wake_fd = ERROR;
+	if(log_file != NULL)
+	{
+		fclose(log_file);
+		log_file = NULL;
+	}
+	while((ring = rings) != NULL)
+	{
+		rings = ring->next;
+		free(ring);
+	}
+}
+/*------------------------------------------------------------------------*/
+void async_log_write(int priority, const char *format, ...)
+{
+	struct log_ring *ring;
+	struct log_record *record;
+	unsigned int tail, used;
+	va_list args;
+	int length;
+
+	va_start(args, format);
+	ring = __atomic_load_n(&log_running, __ATOMIC_ACQUIRE) ? async_log_ring() : NULL;
+	if(ring == NULL)
+	{
+		vsyslog(priority, format, args);
+		va_end(args);
+		return;
+	}
+	/*------------------------------------------------------------------------*/
+	tail = ring->tail;
+	used = tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	if(used >= LOG_RING_RECORDS)
+	{
+		__atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+		va_end(args);
+		return;
+	}
+
+	record = &ring->records[tail & (LOG_RING_RECORDS - 1)];
+	clock_gettime(CLOCK_REALTIME, &record->time);
+	record->priority = priority;
+	length = vsnprintf(record->text, sizeof(record->text), format, args);
+	va_end(args);
+
+	//messages follow the syslog() habit of a trailing newline
+	if(length > (int) sizeof(record->text) - 1)
+	{
+		length = sizeof(record->text) - 1;
+	}
+	while((length > 0) && (record->text[length - 1] == '\n'))
+	{
+		record->text[--length] = '\0';
+	}
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+	//errors are flushed at once, a burst once it fills half the ring
+	if((priority <= LOG_ERR) || (used == (LOG_RING_RECORDS / 2)))
+	{
+		eventfd_write(wake_fd, 1);
+	}
+}
+/*------------------------------------------------------------------------*/
+void async_log_set_level(int priority)
+{
+	__atomic_store_n(&async_log_threshold, priority, __ATOMIC_RELAXED);
+}
+/*------------------------------------------------------------------------*/
+int async_log_parse_level(const char *name)
+{
+	int priority;
+
+	for(priority = LOG_EMERG; priority <= LOG_DEBUG; priority++)
+	{
+		if(!strcasecmp(name, level_names[priority]) ||
+			((name[0] == '0' + priority) && (name[1] == '\0')))
+		{
+			return priority;
+		}
+	}
+	return ERROR;
+}
+/*------------------------------------------------------------------------*/
+const char* async_log_level_name(int priority)
+{
+	return ((priority >= LOG_EMERG) && (priority <= LOG_DEBUG)) ? level_names[priority] : "unknown";
+}
+/*------------------------------------------------------------------------*/
+uint64_t async_log_dropped(void)
+{
+	struct log_ring *ring;
+	uint64_t dropped = 0;
+
+	for(ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next)
+	{
+		dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+	}
+	return dropped;
+}
+/*------------------------------------------------------------------------*/
+static void* async_log_thread(void *arg)
+{
+	struct pollfd fds;
+	eventfd_t count;
+
+	fds.fd 		= wake_fd;
+	fds.events 	= POLLIN;
+
+	while(!__atomic_load_n(&log_stopping, __ATOMIC_SEQ_CST))
+	{
+		if(poll(&fds, 1, LOG_FLUSH_INTERVAL_MS) > 0)
+		{
+			eventfd_read(wake_fd, &count);
+		}
+		async_log_flush();
+	}
+	async_log_flush();
+
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static void async_log_flush(void)
+{
+	struct log_ring *ring;
+	struct log_record *record;
+	struct timespec now;
+	unsigned int head, tail;
+	uint64_t dropped;
+	char text[64];
+
+	for(ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next)
+	{
+		head = ring->head;
+		tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+		for(; head != tail; head++)
+		{
+			record = &ring->records[head & (LOG_RING_RECORDS - 1)];
+			async_log_output(&record->time, record->priority, record->text);
+		}
+		__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+		dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+		if(dropped != ring->reported)
+		{
+			clock_gettime(CLOCK_REALTIME, &now);
+			snprintf(text, sizeof(text), "Dropped %llu log message(s) on a full ring",
+						(unsigned long long) (dropped - ring->reported));
+			async_log_output(&now, LOG_WARNING, text);
+			ring->reported = dropped;
+		}
+	}
+
+	if(log_file != NULL)
+	{
+		fflush(log_file);
+	}
+}
+/*------------------------------------------------------------------------*/
+static void async_log_output(const struct timespec *time, int priority, const char *text)
+{
+	struct tm local;
+	char stamp[32];
+
+	if(log_file == NULL)
+	{
+		syslog(priority, "%s", text);
+		return;
+	}
+
+	localtime_r(&time->tv_sec, &local);
+	strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+	fprintf(log_file, "%s.%03ld %s %s\n", stamp, time->tv_nsec / 1000000,
+				async_log_level_name(priority), text);
+}
+/*------------------------------------------------------------------------*/
+static struct log_ring* async_log_ring(void)
+{
+	struct log_ring *ring = thread_ring;
+
+	if(ring != NULL)
+	{
+		return ring;
+	}
+
+	ring = (struct log_ring *) calloc(1, sizeof(struct log_ring));
+	if(ring == NULL)
+	{
+		return NULL;
+	}
+	ring->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+	while(!__atomic_compare_exchange_n(&rings, &ring->next, ring, true,
+										__ATOMIC_RELEASE, __ATOMIC_RELAXED))
+	{
+	}
+
+	thread_ring = ring;
+	return ring;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,134 @@
+/*
+ * @filename 		:	async-log.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Asynchronous logging for the request path. Every
+ *						thread formats its messages into its own ring of
+ *						LOG_RING_RECORDS records, a push is a vsnprintf()
+ *						and a release store, no lock and no system call.
+ *						A flusher thread empties the rings every
+ *						LOG_FLUSH_INTERVAL_MS, right away for LOG_ERR and
+ *						worse or once a ring is half full, to syslog or
+ *						to a file with -L. Messages keep their order per
+ *						thread, not across threads.
+ *
+ *						A message above the runtime level (-l, LOGLEVEL
+ *						on the admin socket) costs one load and compare,
+ *						its arguments are not evaluated. A message that
+ *						finds its ring full is dropped and counted, the
+ *						flusher logs how many were lost and STATS reports
+ *						the total as log_dropped.
+ *
+ *						Before async_log_start() and after
+ *						async_log_stop() messages go to syslog directly.
+ */
+#ifndef ASYNC_LOG_H_
+#define ASYNC_LOG_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <syslog.h>
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define LOG_RING_RECORDS		(256)	//per thread, a power of two
+#define LOG_RECORD_SIZE			(232)	//longer messages are truncated
+#define LOG_FLUSH_INTERVAL_MS	(100)
+#define DEFAULT_LOG_LEVEL		LOG_DEBUG
+
+//logs like syslog() if priority is enabled, else does nothing
+#define async_log(priority, ...)	\
+	do	\
+	{	\
+		if((priority) <= __atomic_load_n(&async_log_threshold, __ATOMIC_RELAXED))	\
+		{	\
+			async_log_write((priority), __VA_ARGS__);	\
+		}	\
+	} while(0)
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+extern int async_log_threshold;		//least urgent priority logged
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	starts the flusher thread. Must be called after
+ *					daemon().
+ *
+ * @parameters	:	path	:	file to append messages to, NULL for
+ *								syslog
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int async_log_start(const char *path);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	flushes what is left in the rings and stops the
+ *					flusher thread
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void async_log_stop(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	queues one message on the ring of the calling
+ *					thread. Use async_log(), which skips disabled
+ *					priorities before formatting.
+ *
+ * @parameters	:	priority	:	syslog priority, LOG_ERR etc.
+ *					format		:	printf() format and arguments
+ *
+ * @returns		:	none
+ */
+void async_log_write(int priority, const char *format, ...)
+	__attribute__((format(printf, 2, 3)));
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	sets the runtime log level, takes effect at once on
+ *					every thread
+ *
+ * @parameters	:	priority	:	least urgent priority to log
+ *
+ * @returns		:	none
+ */
+void async_log_set_level(int priority);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	parses a log level
+ *
+ * @parameters	:	name	:	emerg, alert, crit, err, warning, notice,
+ *								info, debug or their number 0 to 7
+ *
+ * @returns		:	the priority, ERROR if name is not a level
+ */
+int async_log_parse_level(const char *name);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	name of a log level
+ *
+ * @parameters	:	priority	:	priority 0 to 7
+ *
+ * @returns		:	its name as accepted by async_log_parse_level()
+ */
+const char* async_log_level_name(int priority);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	messages dropped on full rings since startup
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	number of dropped messages
+ */
+uint64_t async_log_dropped(void);
+
+#endif /* ASYNC_LOG_H_ */
+/*EOF*/
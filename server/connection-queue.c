@@ -0,0 +1,109 @@
+/*
+ * @filename 		:	connection-queue.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Bounded FIFO of accepted client sockets.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "aesdsocket.h"
+#include "connection-queue.h"
+#include "server-stats.h"
+
+/*------------------------------------------------------------------------*/
+int connection_queue_init(struct connection_queue *queue, size_t capacity)
+{
+	queue->fds = (int *) calloc(capacity, sizeof(int));
+	if(queue->fds == NULL)
+	{
+		syslog(LOG_ERR,"calloc() failed\n");
+		#if DEBUG
+			printf("calloc() failed\n");
+		#endif
+		return ERROR;
+	}
+
+	queue->capacity = capacity;
+	queue->head 	= 0;
+	queue->count 	= 0;
+	queue->closed 	= false;
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->not_full, NULL);
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int connection_queue_push(struct connection_queue *queue, int clifd)
+{
+	pthread_mutex_lock(&queue->lock);
+	if(queue->count == queue->capacity)
+	{
+		stats_count(STATS_QUEUE_FULL, 1);
+	}
+	while((queue->count == queue->capacity) && !queue->closed)
+	{
+		pthread_cond_wait(&queue->not_full, &queue->lock);
+	}
+	if(queue->closed)
+	{
+		pthread_mutex_unlock(&queue->lock);
+		return ERROR;
+	}
+
+	queue->fds[(queue->head + queue->count) % queue->capacity] = clifd;
+	queue->count++;
+	pthread_mutex_unlock(&queue->lock);
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int connection_queue_pop(struct connection_queue *queue, int *clifd)
+{
+	pthread_mutex_lock(&queue->lock);
+	if(queue->count == 0)
+	{
+		pthread_mutex_unlock(&queue->lock);
+		return ERROR;
+	}
+
+	*clifd 		= queue->fds[queue->head];
+	queue->head = (queue->head + 1) % queue->capacity;
+	queue->count--;
+	pthread_cond_signal(&queue->not_full);
+	pthread_mutex_unlock(&queue->lock);
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+void connection_queue_close(struct connection_queue *queue)
+{
+	pthread_mutex_lock(&queue->lock);
+	queue->closed = true;
+	pthread_cond_broadcast(&queue->not_full);
+	pthread_mutex_unlock(&queue->lock);
+}
+/*------------------------------------------------------------------------*/
+void connection_queue_destroy(struct connection_queue *queue)
+{
+	int clifd;
+
+	while(connection_queue_pop(queue, &clifd) == SUCCESS)
+	{
+		close(clifd);
+	}
+
+	pthread_cond_destroy(&queue->not_full);
+	pthread_mutex_destroy(&queue->lock);
+	free(queue->fds);
+	queue->fds = NULL;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,87 @@
+/*
+ * @filename 		:	connection-queue.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Bounded FIFO of accepted client sockets shared by
+ *						the acceptor and the worker pool. A full queue
+ *						blocks the acceptor, which leaves further clients
+ *						waiting in the kernel's listen backlog.
+ */
+#ifndef CONNECTION_QUEUE_H_
+#define CONNECTION_QUEUE_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+/*------------------------------------------------------------------------*/
+/*							QUEUE STRUCTURE								  */
+/*------------------------------------------------------------------------*/
+struct connection_queue
+{
+	int *fds;					//ring of accepted sockets
+	size_t capacity;
+	size_t head;				//next slot to pop
+	size_t count;
+	bool closed;				//set once the queue is shutting down
+	pthread_mutex_t lock;
+	pthread_cond_t not_full;
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	allocates the ring and initializes the queue
+ *
+ * @parameters	:	queue		:	queue to initialize
+ *					capacity	:	maximum number of queued sockets
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int connection_queue_init(struct connection_queue *queue, size_t capacity);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	appends a socket, blocking while the queue is full
+ *
+ * @parameters	:	queue	:	queue to append to
+ *					clifd	:	accepted client socket
+ *
+ * @returns		:	SUCCESS on success, ERROR once the queue is closed
+ */
+int connection_queue_push(struct connection_queue *queue, int clifd);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	removes the oldest socket without blocking
+ *
+ * @parameters	:	queue	:	queue to pop from
+ *					clifd	:	filled with the socket on success
+ *
+ * @returns		:	SUCCESS on success, ERROR if the queue is empty
+ */
+int connection_queue_pop(struct connection_queue *queue, int *clifd);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	wakes a blocked producer and refuses further pushes
+ *
+ * @parameters	:	queue	:	queue to close
+ *
+ * @returns		:	none
+ */
+void connection_queue_close(struct connection_queue *queue);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	closes every socket still queued and frees the ring
+ *
+ * @parameters	:	queue	:	queue to destroy
+ *
+ * @returns		:	none
+ */
+void connection_queue_destroy(struct connection_queue *queue);
+
+#endif /* CONNECTION_QUEUE_H_ */
+/*EOF*/
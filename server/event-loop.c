@@ -0,0 +1,1543 @@
+/*
+ * @filename 		:	event-loop.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						epoll based connection engine. Replaces the thread
+ *						per connection model: every loop thread owns an
+ *						epoll instance and services all of its clients
+ *						with non-blocking sockets, so a slow peer only
+ *						delays itself.
+ *
+ *						The loops form a fixed size worker pool that is
+ *						fed by the acceptor through a bounded
+ *						connection queue; workers are reused for every
+ *						connection and never created per client.
+ *
+ *						By default a connection is closed once its first
+ *						packet has been answered. In session mode (-k) a
+ *						client may send any number of packets, pipelined
+ *						or not, and every packet is answered in order on
+ *						the same socket.
+ *
+ *						A client that sends SINCE_COMMAND switches its
+ *						connection to incremental replies: the command
+ *						is answered with the history from the given
+ *						offset and every later reply only carries the
+ *						bytes appended since the previous one.
+ *
+ *						Packets are not written by the loops. They are
+ *						submitted to the storage writer thread, which
+ *						hands them back through the completion queue of
+ *						the loop once committed and snapshotted.
+ *
+ *						With the uring engine (-e uring) every loop owns
+ *						an io_uring instance instead of an epoll one.
+ *						Clients are read with multishot receives into a
+ *						ring of provided buffers and the wakeup eventfds
+ *						with multishot polls, so an idle connection costs
+ *						no syscall and all re-arming of a loop iteration
+ *						is submitted in one io_uring_enter(). Replies
+ *						still go through the reply engine, a socket that
+ *						would block is waited for with a POLLOUT request.
+ *						If the kernel lacks io_uring or provided buffer
+ *						rings the loops fall back to epoll.
+ *
+ *						A graceful stop drains the loops: connections
+ *						finish their packet and reply, sessions are closed
+ *						once they rest between packets, and whatever is
+ *						left at the deadline is closed by the stop.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <syslog.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/queue.h>
+
+#include "aesdsocket.h"
+#include "event-loop.h"
+#include "connection-queue.h"
+#include "packet-framer.h"
+#include "reply-engine.h"
+#include "server-stats.h"
+#include "storage-backend.h"
+#include "storage-writer.h"
+#include "mpsc-queue.h"
+#include "uring.h"
+#include "admission.h"
+#include "async-log.h"
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define MAX_EVENTS			(64)
+#define MAX_PIPELINED_REPLIES	(64)	//replies queued before reading pauses
+#define DRAIN_POLL_NS		(10 * 1000 * 1000)
+
+#define URING_ENTRIES		(256)	//submission queue entries per loop
+#define URING_BUFFERS		(256)	//provided receive buffers per loop
+#define URING_BUFFER_SIZE	(4096)
+#define URING_BUFFER_GROUP	(0)
+
+//io_uring user_data: the wakeup eventfds, or a connection pointer with
+//the operation in its low bit
+#define URING_WAKE			(1)		//evfd became readable
+#define URING_DONE			(2)		//donefd became readable
+#define URING_IGNORE		(3)		//cancel requests
+#define URING_SPECIAL_MAX	(4096)	//no connection lives this low
+#define URING_OP_RECV		(0)
+#define URING_OP_POLLOUT	(1)
+#define URING_OP_MASK		(1)
+
+//return values of the per connection handlers
+#define CONNECTION_OPEN		(1)
+#define CONNECTION_CLOSE	(0)
+
+/*------------------------------------------------------------------------*/
+/*						STRUCTURES FOR CONNECTION HANDLING				  */
+/*------------------------------------------------------------------------*/
+struct pending_reply
+{
+	struct reply reply;
+	bool committed;			//the storage writer took the snapshot
+	bool streaming;			//storage_stream() has been called
+	uint64_t started;		//stats_now() when streaming began
+	STAILQ_ENTRY(pending_reply) entries;
+};
+
+struct connection
+{
+	int clifd;
+	struct event_loop *loop;	//loop owning the connection
+	bool read_closed;		//peer finished sending, or single packet handled
+	bool closed;			//socket closed, freed once inflight drops to 0
+	uint32_t events;		//epoll events currently registered
+	bool registered;		//epoll: clifd was added to epfd
+	bool recv_armed;		//uring: a receive is outstanding
+	bool recv_cancelled;	//uring: and a cancel for it was submitted
+	bool pollout_armed;		//uring: a POLLOUT request is outstanding
+	bool incremental;		//SINCE_COMMAND received
+	bool served;			//a reply was sent completely
+	size_t since;			//first history byte of the next reply, owned
+							//by the storage writer
+	size_t inflight;		//requests submitted to the storage writer
+	size_t charged;			//framer bytes charged to the memory budget
+	struct packet_framer framer;	//packet assembly state
+	STAILQ_HEAD(reply_list, pending_reply) replies;	//answered in order
+	size_t reply_count;
+	LIST_ENTRY(connection) entries;
+};
+
+struct event_loop
+{
+	pthread_t thread_id;
+	int epfd;					//epoll instance of this loop, -1 with uring
+	bool use_uring;				//ring replaces epfd
+	bool recv_multishot;		//kernel accepted IORING_RECV_MULTISHOT so far
+	struct uring ring;
+	int evfd;					//wakes the loop for new connections / stop
+	int donefd;					//wakes the loop for completed requests
+	struct mpsc_queue completions;	//requests handed back by the writer
+	LIST_HEAD(connection_list, connection) connections;
+};
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static struct event_loop	*loops			= NULL;
+static int 					loop_count		= 0;
+static unsigned int			next_loop		= 0;		//round robin dispatch
+static volatile bool		loops_stopping	= false;
+static bool					loops_halted	= false;	//loop threads joined
+static volatile bool		loops_draining	= false;	//close sessions at rest
+static struct connection_queue	queue;					//accepted, not yet owned
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	thread function of a loop, waits for events and
+ *					dispatches them to the connection handlers
+ *
+ * @parameters	:	arg	:	struct event_loop owned by this thread
+ *
+ * @returns		:	NULL
+ */
+static void* event_loop_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	body of a loop thread with the uring engine, reaps
+ *					completions and submits the requests they re-arm
+ *					in one io_uring_enter() per iteration
+ *
+ * @parameters	:	loop	:	loop owned by this thread
+ *
+ * @returns		:	none
+ */
+static void event_loop_run_uring(struct event_loop *loop);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	queues a multishot poll for readability of an
+ *					eventfd of the loop
+ *
+ * @parameters	:	loop		:	loop owning the ring
+ *					fd			:	eventfd to watch
+ *					user_data	:	URING_WAKE or URING_DONE
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int event_loop_uring_poll(struct event_loop *loop, int fd, uint64_t user_data);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	takes one queued connection per wakeup from the
+ *					connection queue and registers it with the epoll
+ *					instance of the loop
+ *
+ * @parameters	:	loop	:	loop to service
+ *
+ * @returns		:	none
+ */
+static void event_loop_accept_pending(struct event_loop *loop);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	takes the requests completed by the storage writer
+ *					and services the connections they belong to
+ *
+ * @parameters	:	loop	:	loop to service
+ *
+ * @returns		:	none
+ */
+static void event_loop_complete(struct event_loop *loop);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	closes the sessions of the loop that rest between
+ *					packets, called on every wakeup while draining
+ *
+ * @parameters	:	loop	:	loop to service
+ *
+ * @returns		:	none
+ */
+static void event_loop_close_idle(struct event_loop *loop);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	takes back the requests the storage writer completed
+ *					for a halted loop, without answering them
+ *
+ * @parameters	:	loop	:	loop whose thread has been joined
+ *
+ * @returns		:	none
+ */
+static void event_loop_reap(struct event_loop *loop);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	reads from the client socket into the packet framer
+ *					and handles the completed packets, until the socket
+ *					would block or no more replies may be queued
+ *
+ * @parameters	:	conn	:	connection to read from
+ *
+ * @returns		:	CONNECTION_OPEN or CONNECTION_CLOSE
+ */
+static int connection_read(struct connection *conn);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	makes room in the packet framer, charging any growth
+ *					to the memory budget
+ *
+ * @parameters	:	conn		:	connection owning the framer
+ *					min_space	:	minimum number of free bytes
+ *					available	:	filled with the number of free bytes
+ *
+ * @returns		:	pointer to the free space, NULL on allocation
+ *					failure or when the budget is exhausted
+ */
+static char* connection_reserve(struct connection *conn, size_t min_space, size_t *available);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	copies bytes received by the ring into the packet
+ *					framer and handles the completed packets
+ *
+ * @parameters	:	conn	:	connection the bytes belong to
+ *					data	:	received bytes
+ *					length	:	number of bytes
+ *
+ * @returns		:	CONNECTION_OPEN or CONNECTION_CLOSE
+ */
+static int connection_receive(struct connection *conn, const char *data, size_t length);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	handles the completion of a receive or POLLOUT
+ *					request of a connection
+ *
+ * @parameters	:	loop	:	loop owning the connection
+ *					conn	:	connection the request belongs to
+ *					op		:	URING_OP_RECV or URING_OP_POLLOUT
+ *					cqe		:	copy of the completion
+ *
+ * @returns		:	none
+ */
+static void connection_uring_complete(struct event_loop *loop, struct connection *conn,
+										int op, const struct io_uring_cqe *cqe);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	sends the queued replies in order, as far as the
+ *					socket accepts them and the storage writer has
+ *					committed them
+ *
+ * @parameters	:	conn	:	connection to write to
+ *
+ * @returns		:	REPLY_DONE once nothing more can be sent,
+ *					REPLY_AGAIN if the socket would block, ERROR on
+ *					failure
+ */
+static int connection_write(struct connection *conn);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	flushes replies, takes further buffered packets as
+ *					replies drain and updates the epoll registration
+ *
+ * @parameters	:	loop	:	loop owning the connection
+ *					conn	:	connection to service
+ *
+ * @returns		:	CONNECTION_OPEN or CONNECTION_CLOSE
+ */
+static int connection_service(struct event_loop *loop, struct connection *conn);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	makes the loop watch the connection for events.
+ *					With epoll the registration is added or modified,
+ *					with io_uring a receive is armed or cancelled and a
+ *					POLLOUT request armed as needed.
+ *
+ * @parameters	:	loop	:	loop owning the connection
+ *					conn	:	connection to watch
+ *					events	:	EPOLLIN and/or EPOLLOUT wanted
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int connection_watch(struct event_loop *loop, struct connection *conn, uint32_t events);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	submits the complete packets held by the framer to
+ *					the storage writer and queues their replies. In
+ *					session mode every packet gets its own reply,
+ *					otherwise one reply covers the batch and reading
+ *					stops.
+ *
+ * @parameters	:	conn	:	connection to take the packets from
+ *
+ * @returns		:	number of packets submitted, ERROR on failure
+ */
+static int connection_handle_packets(struct connection *conn);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	recognizes SINCE_COMMAND
+ *
+ * @parameters	:	packet	:	packet including its newline
+ *					length	:	size of the packet
+ *					since	:	offset given by the command
+ *
+ * @returns		:	true if the packet was the command and must not be
+ *					stored
+ */
+static bool connection_parse_since(const char *packet, size_t length, size_t *since);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	removes the connection from its loop and closes the
+ *					socket. Its buffers are freed at once, or when the
+ *					last request still at the storage writer returns.
+ *
+ * @parameters	:	loop	:	loop owning the connection
+ *					conn	:	connection to close
+ *
+ * @returns		:	none
+ */
+static void connection_close(struct event_loop *loop, struct connection *conn);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	frees a closed connection and its queued replies
+ *
+ * @parameters	:	conn	:	connection to free
+ *
+ * @returns		:	none
+ */
+static void connection_free(struct connection *conn);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	frees a closed connection once neither the storage
+ *					writer nor the ring refers to it any more
+ *
+ * @parameters	:	conn	:	closed connection
+ *
+ * @returns		:	none
+ */
+static void connection_release(struct connection *conn);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	whether a session rests between packets: it was
+ *					answered before and holds no partial packet, no
+ *					pending reply and no request at the storage writer
+ *
+ * @parameters	:	conn	:	connection to check
+ *
+ * @returns		:	true if closing it loses nothing
+ */
+static bool connection_idle(struct connection *conn);
+
+/*------------------------------------------------------------------------*/
+int event_loop_start(int nloops, size_t queue_depth, bool use_uring)
+{
+	sigset_t blocked, previous;
+	struct epoll_event event;
+	int i, j, status;
+
+	if(nloops <= 0)
+	{
+		nloops = (int) sysconf(_SC_NPROCESSORS_ONLN);
+		if(nloops <= 0)
+		{
+			nloops = 1;
+		}
+	}
+
+	loops = (struct event_loop *) calloc(nloops, sizeof(struct event_loop));
+	if(loops == NULL)
+	{
+		syslog(LOG_ERR,"calloc() failed\n");
+		#if DEBUG
+			printf("calloc() failed\n");
+		#endif
+		return ERROR;
+	}
+	loop_count = nloops;
+
+	if(connection_queue_init(&queue, queue_depth) == ERROR)
+	{
+		return ERROR;
+	}
+	/*------------------------------------------------------------------------*/
+	//every ring is set up before any thread runs, so a kernel without
+	//io_uring or provided buffer rings leaves all loops on epoll
+	for(i = 0; use_uring && (i < loop_count); i++)
+	{
+		if((uring_init(&loops[i].ring, URING_ENTRIES) == ERROR) ||
+			(uring_setup_buffers(&loops[i].ring, URING_BUFFERS, URING_BUFFER_SIZE, URING_BUFFER_GROUP) == ERROR))
+		{
+			for(j = 0; j <= i; j++)
+			{
+				uring_destroy(&loops[j].ring);
+			}
+			use_uring = false;
+			syslog(LOG_WARNING,"io_uring unavailable, falling back to epoll\n");
+			#if DEBUG
+				printf("io_uring unavailable, falling back to epoll\n");
+			#endif
+		}
+	}
+
+	//signals are handled by the main thread only
+	sigemptyset(&blocked);
+	sigaddset(&blocked, SIGINT);
+	sigaddset(&blocked, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+
+	for(i = 0; i < loop_count; i++)
+	{
+		LIST_INIT(&loops[i].connections);
+		loops[i].use_uring = use_uring;
+		loops[i].recv_multishot = true;
+		if(!use_uring)
+		{
+			loops[i].ring.fd = ERROR;
+		}
+
+		loops[i].epfd = use_uring ? ERROR : epoll_create1(EPOLL_CLOEXEC);
+		loops[i].evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		loops[i].donefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		mpsc_queue_init(&loops[i].completions);
+		if((!use_uring && (loops[i].epfd == ERROR)) || (loops[i].evfd == ERROR) || (loops[i].donefd == ERROR))
+		{
+			syslog(LOG_ERR,"epoll_create1()/eventfd() failed\n");
+			#if DEBUG
+				printf("epoll_create1()/eventfd() failed\n");
+			#endif
+			pthread_sigmask(SIG_SETMASK, &previous, NULL);
+			return ERROR;
+		}
+
+		//the ring watches the eventfds itself once its thread runs
+		if(!use_uring)
+		{
+			//a NULL data pointer identifies the wakeup eventfd
+			memset(&event, 0, sizeof(event));
+			event.events 	= EPOLLIN;
+			event.data.ptr 	= NULL;
+			status = epoll_ctl(loops[i].epfd, EPOLL_CTL_ADD, loops[i].evfd, &event);
+
+			//and the loop itself the completion eventfd
+			event.data.ptr 	= &loops[i];
+			if(status != ERROR)
+			{
+				status = epoll_ctl(loops[i].epfd, EPOLL_CTL_ADD, loops[i].donefd, &event);
+			}
+			if(status == ERROR)
+			{
+				syslog(LOG_ERR,"epoll_ctl() failed\n");
+				#if DEBUG
+					printf("epoll_ctl() failed\n");
+				#endif
+				pthread_sigmask(SIG_SETMASK, &previous, NULL);
+				return ERROR;
+			}
+		}
+
+		status = pthread_create(&loops[i].thread_id, NULL, event_loop_thread, &loops[i]);
+		if(status != SUCCESS)
+		{
+			syslog(LOG_ERR,"pthread_create() failed\n");
+			#if DEBUG
+				printf("pthread_create() failed\n");
+			#endif
+			pthread_sigmask(SIG_SETMASK, &previous, NULL);
+			return ERROR;
+		}
+	}
+
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+	syslog(LOG_INFO,"Started %d %s worker(s), queue depth %zu\n", loop_count,
+			use_uring ? "io_uring" : "epoll", queue_depth);
+	#if DEBUG
+		printf("Started %d %s worker(s), queue depth %zu\n", loop_count,
+				use_uring ? "io_uring" : "epoll", queue_depth);
+	#endif
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int event_loop_add_connection(int clifd)
+{
+	if(admission_connection_open() == ERROR)
+	{
+		stats_count(STATS_CONNECTIONS_REJECTED, 1);
+		async_log(LOG_WARNING,"Connection limit reached, rejecting fd %d\n", clifd);
+		#if DEBUG
+			printf("Connection limit reached, rejecting fd %d\n", clifd);
+		#endif
+		close(clifd);
+		return ERROR;
+	}
+
+	//blocks while every queue slot is taken, which stops the acceptor
+	//and leaves further clients in the listen backlog
+	if(connection_queue_push(&queue, clifd) == ERROR)
+	{
+		admission_connection_close();
+		close(clifd);
+		return ERROR;
+	}
+
+	//several acceptors may dispatch at once
+	eventfd_write(loops[__atomic_fetch_add(&next_loop, 1, __ATOMIC_RELAXED) % loop_count].evfd, 1);
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+void event_loop_refuse(void)
+{
+	if(loops != NULL)
+	{
+		connection_queue_close(&queue);
+	}
+}
+/*------------------------------------------------------------------------*/
+void event_loop_drain(unsigned int seconds)
+{
+	struct timespec pause = { .tv_sec = 0, .tv_nsec = DRAIN_POLL_NS };
+	struct timespec now;
+	time_t deadline;
+	int i;
+
+	if(loops == NULL)
+	{
+		return;
+	}
+
+	loops_draining = true;
+	for(i = 0; i < loop_count; i++)
+	{
+		eventfd_write(loops[i].evfd, 1);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	deadline = now.tv_sec + seconds;
+	while((admission_connections() > 0) && (now.tv_sec < deadline))
+	{
+		nanosleep(&pause, NULL);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+	}
+
+	syslog(LOG_INFO,"Drained connections, %zu left\n", admission_connections());
+	#if DEBUG
+		printf("Drained connections, %zu left\n", admission_connections());
+	#endif
+}
+/*------------------------------------------------------------------------*/
+void event_loop_halt(void)
+{
+	int i;
+
+	if((loops == NULL) || loops_halted)
+	{
+		return;
+	}
+
+	connection_queue_close(&queue);
+	loops_stopping = true;
+	for(i = 0; i < loop_count; i++)
+	{
+		eventfd_write(loops[i].evfd, 1);
+	}
+	for(i = 0; i < loop_count; i++)
+	{
+		pthread_join(loops[i].thread_id, NULL);
+	}
+	loops_halted = true;
+}
+/*------------------------------------------------------------------------*/
+void event_loop_stop(void)
+{
+	struct connection *conn;
+	int i;
+
+	if(loops == NULL)
+	{
+		return;
+	}
+
+	event_loop_halt();
+	for(i = 0; i < loop_count; i++)
+	{
+		//requests still with the storage writer keep their connection
+		event_loop_reap(&loops[i]);
+
+		//nothing reaps the ring any more, its requests die with it
+		while((conn = LIST_FIRST(&loops[i].connections)) != NULL)
+		{
+			conn->recv_armed = false;
+			conn->pollout_armed = false;
+			connection_close(&loops[i], conn);
+		}
+		close(loops[i].evfd);
+		close(loops[i].donefd);
+		if(loops[i].use_uring)
+		{
+			uring_destroy(&loops[i].ring);
+		}
+		else
+		{
+			close(loops[i].epfd);
+		}
+	}
+
+	connection_queue_destroy(&queue);
+	free(loops);
+	loops = NULL;
+	loop_count = 0;
+	loops_stopping = false;
+	loops_halted = false;
+}
+/*------------------------------------------------------------------------*/
+static void* event_loop_thread(void *arg)
+{
+	struct event_loop *loop = (struct event_loop *) arg;
+	struct epoll_event events[MAX_EVENTS];
+	struct connection *conn;
+	bool completed, woken;
+	char name[16];
+	int nevents, i, status;
+
+	snprintf(name, sizeof(name), "loop%d", (int) (loop - loops));
+	stats_thread_register(name);
+
+	if(loop->use_uring)
+	{
+		event_loop_run_uring(loop);
+		return NULL;
+	}
+
+	while(!loops_stopping)
+	{
+		nevents = epoll_wait(loop->epfd, events, MAX_EVENTS, -1);
+		if(nevents == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			async_log(LOG_ERR,"epoll_wait() failed\n");
+			#if DEBUG
+				printf("epoll_wait() failed\n");
+			#endif
+			break;
+		}
+		/*------------------------------------------------------------------------*/
+		//the wakeups may close connections, they are handled after the
+		//batch so no event left in it refers to a freed connection
+		completed 	= false;
+		woken 		= false;
+		for(i = 0; i < nevents; i++)
+		{
+			if(events[i].data.ptr == loop)
+			{
+				completed = true;
+				continue;
+			}
+			conn = (struct connection *) events[i].data.ptr;
+			if(conn == NULL)
+			{
+				woken = true;
+				continue;
+			}
+
+			status = CONNECTION_OPEN;
+			if(!conn->read_closed && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+			{
+				status = connection_read(conn);
+			}
+			else if(events[i].events & (EPOLLHUP | EPOLLERR))
+			{
+				//hangup and error stay level triggered whatever is armed,
+				//a half closed session waiting on the storage writer is
+				//dropped here and freed once its requests come back
+				status = CONNECTION_CLOSE;
+			}
+			if(status == CONNECTION_OPEN)
+			{
+				status = connection_service(loop, conn);
+			}
+
+			if(status == CONNECTION_CLOSE)
+			{
+				connection_close(loop, conn);
+			}
+		}
+		if(completed)
+		{
+			event_loop_complete(loop);
+		}
+		if(woken)
+		{
+			event_loop_accept_pending(loop);
+		}
+	}
+
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static void event_loop_run_uring(struct event_loop *loop)
+{
+	struct io_uring_cqe *cqe, completion;
+	struct connection *conn;
+	uint64_t user_data;
+
+	if((uring_enable(&loop->ring) == ERROR) ||
+		(event_loop_uring_poll(loop, loop->evfd, URING_WAKE) == ERROR) ||
+		(event_loop_uring_poll(loop, loop->donefd, URING_DONE) == ERROR))
+	{
+		return;
+	}
+
+	while(!loops_stopping)
+	{
+		if(uring_submit(&loop->ring, 1) == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			async_log(LOG_ERR,"io_uring_enter() failed\n");
+			#if DEBUG
+				printf("io_uring_enter() failed\n");
+			#endif
+			break;
+		}
+		/*------------------------------------------------------------------------*/
+		while((cqe = uring_peek_cqe(&loop->ring)) != NULL)
+		{
+			//the slot is handed back first so that requests armed by the
+			//handlers have room in the completion queue
+			completion = *cqe;
+			uring_cqe_seen(&loop->ring);
+			user_data = completion.user_data;
+
+			if(user_data < URING_SPECIAL_MAX)
+			{
+				if(user_data == URING_IGNORE)
+				{
+					continue;
+				}
+				if(user_data == URING_WAKE)
+				{
+					event_loop_accept_pending(loop);
+				}
+				else
+				{
+					event_loop_complete(loop);
+				}
+				//a multishot poll ends on overflow or error
+				if(!(completion.flags & IORING_CQE_F_MORE))
+				{
+					event_loop_uring_poll(loop, (user_data == URING_WAKE) ? loop->evfd : loop->donefd, user_data);
+				}
+				continue;
+			}
+
+			conn = (struct connection *) (uintptr_t) (user_data & ~(uint64_t) URING_OP_MASK);
+			connection_uring_complete(loop, conn, (int) (user_data & URING_OP_MASK), &completion);
+		}
+	}
+}
+/*------------------------------------------------------------------------*/
+static int event_loop_uring_poll(struct event_loop *loop, int fd, uint64_t user_data)
+{
+	struct io_uring_sqe *sqe;
+
+	sqe = uring_get_sqe(&loop->ring);
+	if(sqe == NULL)
+	{
+		async_log(LOG_ERR,"uring_get_sqe() failed\n");
+		#if DEBUG
+			printf("uring_get_sqe() failed\n");
+		#endif
+		return ERROR;
+	}
+	sqe->opcode 		= IORING_OP_POLL_ADD;
+	sqe->fd 			= fd;
+	sqe->poll32_events 	= POLLIN;
+	sqe->len 			= IORING_POLL_ADD_MULTI;
+	sqe->user_data 		= user_data;
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static void event_loop_accept_pending(struct event_loop *loop)
+{
+	struct connection *conn;
+	eventfd_t count = 0;
+	int clifd;
+
+	eventfd_read(loop->evfd, &count);
+
+	//every push is announced to exactly one loop, so popping at most
+	//count sockets keeps the pool balanced. The acceptors hand over
+	//sockets that are already non-blocking.
+	while((count-- > 0) && (connection_queue_pop(&queue, &clifd) == SUCCESS))
+	{
+		conn = (struct connection *) calloc(1, sizeof(struct connection));
+		if(conn == NULL)
+		{
+			async_log(LOG_ERR,"calloc() failed\n");
+			#if DEBUG
+				printf("calloc() failed\n");
+			#endif
+			admission_connection_close();
+			close(clifd);
+			continue;
+		}
+		conn->clifd = clifd;
+		conn->loop = loop;
+		packet_framer_init(&conn->framer, config.max_packet);
+		STAILQ_INIT(&conn->replies);
+
+		if(connection_watch(loop, conn, EPOLLIN | EPOLLRDHUP) == ERROR)
+		{
+			admission_connection_close();
+			close(conn->clifd);
+			free(conn);
+			continue;
+		}
+		LIST_INSERT_HEAD(&loop->connections, conn, entries);
+		stats_count(STATS_CONNECTIONS_OPENED, 1);
+	}
+
+	if(loops_draining)
+	{
+		event_loop_close_idle(loop);
+	}
+}
+/*------------------------------------------------------------------------*/
+static void event_loop_close_idle(struct event_loop *loop)
+{
+	struct connection *conn, *next;
+
+	for(conn = LIST_FIRST(&loop->connections); conn != NULL; conn = next)
+	{
+		next = LIST_NEXT(conn, entries);
+		if(connection_idle(conn))
+		{
+			connection_close(loop, conn);
+		}
+	}
+}
+/*------------------------------------------------------------------------*/
+static void event_loop_complete(struct event_loop *loop)
+{
+	struct storage_request *request;
+	struct pending_reply *pending;
+	struct connection *conn;
+	struct mpsc_node *node;
+	eventfd_t count;
+	int status;
+
+	eventfd_read(loop->donefd, &count);
+
+	while((node = mpsc_queue_pop(&loop->completions)) != NULL)
+	{
+		request = mpsc_entry(node, struct storage_request, node);
+		conn = (struct connection *) request->context;
+		status = request->status;
+		if(request->reply != NULL)
+		{
+			pending = mpsc_entry(request->reply, struct pending_reply, reply);
+			pending->committed = true;
+		}
+		admission_release(request->length);
+		free(request);
+		conn->inflight--;
+		/*------------------------------------------------------------------------*/
+		if(conn->closed)
+		{
+			connection_release(conn);
+			continue;
+		}
+
+		if(status == SUCCESS)
+		{
+			status = (connection_service(loop, conn) == CONNECTION_OPEN) ? SUCCESS : ERROR;
+		}
+		if(status == ERROR)
+		{
+			connection_close(loop, conn);
+		}
+	}
+}
+/*------------------------------------------------------------------------*/
+static void event_loop_reap(struct event_loop *loop)
+{
+	struct storage_request *request;
+	struct connection *conn;
+	struct mpsc_node *node;
+
+	while((node = mpsc_queue_pop(&loop->completions)) != NULL)
+	{
+		request = mpsc_entry(node, struct storage_request, node);
+		conn = (struct connection *) request->context;
+		admission_release(request->length);
+		free(request);
+		conn->inflight--;
+		if(conn->closed)
+		{
+			connection_release(conn);
+		}
+	}
+}
+/*------------------------------------------------------------------------*/
+static int connection_read(struct connection *conn)
+{
+	ssize_t received;
+	size_t available;
+	uint64_t start;
+	char *space;
+
+	while(!conn->read_closed && (conn->reply_count < MAX_PIPELINED_REPLIES))
+	{
+		space = connection_reserve(conn, BUFFER_SIZE, &available);
+		if(space == NULL)
+		{
+			return CONNECTION_CLOSE;
+		}
+
+		start = stats_now();
+		received = recv(conn->clifd, space, available, 0);
+		if(received == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			{
+				return CONNECTION_OPEN;
+			}
+			async_log(LOG_ERR,"recv() failed\n");
+			#if DEBUG
+				printf("recv() failed\n");
+			#endif
+			return CONNECTION_CLOSE;
+		}
+		if(received == 0)
+		{
+			//peer is done sending, an incomplete packet is dropped and
+			//the replies already queued are still delivered
+			conn->read_closed = true;
+			return CONNECTION_OPEN;
+		}
+		stats_record(STATS_RECV, start);
+		stats_count(STATS_BYTES_IN, received);
+		packet_framer_commit(&conn->framer, received);
+		/*------------------------------------------------------------------------*/
+		if(connection_handle_packets(conn) == ERROR)
+		{
+			return CONNECTION_CLOSE;
+		}
+	}
+
+	return CONNECTION_OPEN;
+}
+/*------------------------------------------------------------------------*/
+static char* connection_reserve(struct connection *conn, size_t min_space, size_t *available)
+{
+	size_t size, growth = 0;
+	char *space;
+
+	//the growth is charged before it is allocated, so the budget
+	//bounds the memory actually taken
+	size = packet_framer_capacity(&conn->framer, min_space);
+	if(size > conn->charged)
+	{
+		growth = size - conn->charged;
+		if(admission_charge(growth) == ERROR)
+		{
+			stats_count(STATS_BUDGET_EXCEEDED, 1);
+			async_log(LOG_WARNING,"Memory budget exceeded on fd %d, closing\n", conn->clifd);
+			#if DEBUG
+				printf("Memory budget exceeded on fd %d, closing\n", conn->clifd);
+			#endif
+			return NULL;
+		}
+	}
+
+	space = packet_framer_reserve(&conn->framer, min_space, available);
+	if(space == NULL)
+	{
+		admission_release(growth);
+		return NULL;
+	}
+	conn->charged += growth;
+	return space;
+}
+/*------------------------------------------------------------------------*/
+static int connection_receive(struct connection *conn, const char *data, size_t length)
+{
+	size_t available;
+	uint64_t start;
+	char *space;
+
+	//bytes still in flight when reading paused or stopped
+	if(conn->read_closed)
+	{
+		return CONNECTION_OPEN;
+	}
+
+	//the recv stage covers the copy out of the provided buffer
+	start = stats_now();
+	space = connection_reserve(conn, length, &available);
+	if(space == NULL)
+	{
+		return CONNECTION_CLOSE;
+	}
+	memcpy(space, data, length);
+	stats_record(STATS_RECV, start);
+	stats_count(STATS_BYTES_IN, length);
+	packet_framer_commit(&conn->framer, length);
+
+	return (connection_handle_packets(conn) == ERROR) ? CONNECTION_CLOSE : CONNECTION_OPEN;
+}
+/*------------------------------------------------------------------------*/
+static void connection_uring_complete(struct event_loop *loop, struct connection *conn,
+										int op, const struct io_uring_cqe *cqe)
+{
+	int status = CONNECTION_OPEN;
+
+	if(op == URING_OP_POLLOUT)
+	{
+		conn->pollout_armed = false;
+		if((cqe->res < 0) && (cqe->res != -ECANCELED))
+		{
+			status = CONNECTION_CLOSE;
+		}
+	}
+	else
+	{
+		if(!(cqe->flags & IORING_CQE_F_MORE))
+		{
+			conn->recv_armed = false;
+			conn->recv_cancelled = false;
+		}
+
+		if(cqe->flags & IORING_CQE_F_BUFFER)
+		{
+			if(!conn->closed)
+			{
+				status = connection_receive(conn, uring_buffer(&loop->ring, cqe->flags >> IORING_CQE_BUFFER_SHIFT), cqe->res);
+			}
+			uring_buffer_recycle(&loop->ring, cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+		}
+		else if(cqe->res == 0)
+		{
+			//peer is done sending, see connection_read()
+			conn->read_closed = true;
+		}
+		else if((cqe->res == -EINVAL) && loop->recv_multishot)
+		{
+			//pre 6.0 kernel, receives are re-armed one at a time
+			loop->recv_multishot = false;
+		}
+		else if((cqe->res != -ENOBUFS) && (cqe->res != -ECANCELED) && (cqe->res != -EINTR))
+		{
+			status = CONNECTION_CLOSE;
+		}
+	}
+	/*------------------------------------------------------------------------*/
+	if(conn->closed)
+	{
+		connection_release(conn);
+		return;
+	}
+
+	//re-arms whatever just ended
+	if(status == CONNECTION_OPEN)
+	{
+		status = connection_service(loop, conn);
+	}
+	if(status == CONNECTION_CLOSE)
+	{
+		connection_close(loop, conn);
+	}
+}
+/*------------------------------------------------------------------------*/
+static int connection_write(struct connection *conn)
+{
+	struct pending_reply *pending;
+	int status;
+
+	while((pending = STAILQ_FIRST(&conn->replies)) != NULL)
+	{
+		if(!pending->committed)
+		{
+			//the rest is sent once the storage writer hands it back
+			return REPLY_DONE;
+		}
+
+		//storage is opened only once the reply is due, so a deep
+		//pipeline does not hold a descriptor per queued reply
+		if(!pending->streaming)
+		{
+			if(storage_stream(&pending->reply) == ERROR)
+			{
+				return ERROR;
+			}
+			pending->streaming = true;
+			pending->started = stats_now();
+		}
+
+		status = reply_send(&pending->reply, conn->clifd);
+		if(status != REPLY_DONE)
+		{
+			return status;
+		}
+
+		stats_record(STATS_REPLY, pending->started);
+		conn->served = true;
+		STAILQ_REMOVE_HEAD(&conn->replies, entries);
+		reply_release(&pending->reply);
+		free(pending);
+		conn->reply_count--;
+	}
+
+	return REPLY_DONE;
+}
+/*------------------------------------------------------------------------*/
+static int connection_service(struct event_loop *loop, struct connection *conn)
+{
+	uint32_t events;
+	int status, packets;
+
+	while(true)
+	{
+		status = connection_write(conn);
+		if(status == ERROR)
+		{
+			return CONNECTION_CLOSE;
+		}
+		if(conn->read_closed || (conn->reply_count >= MAX_PIPELINED_REPLIES))
+		{
+			break;
+		}
+
+		//packets left in the framer while the pipeline was full
+		packets = connection_handle_packets(conn);
+		if(packets == ERROR)
+		{
+			return CONNECTION_CLOSE;
+		}
+		if(packets == 0)
+		{
+			break;
+		}
+	}
+
+	if(conn->read_closed && (conn->reply_count == 0))
+	{
+		return CONNECTION_CLOSE;
+	}
+	if(loops_draining && connection_idle(conn))
+	{
+		return CONNECTION_CLOSE;
+	}
+	/*------------------------------------------------------------------------*/
+	events = 0;
+	if(!conn->read_closed && (conn->reply_count < MAX_PIPELINED_REPLIES))
+	{
+		events |= EPOLLIN | EPOLLRDHUP;
+	}
+	if(status == REPLY_AGAIN)
+	{
+		events |= EPOLLOUT;
+	}
+
+	if(connection_watch(loop, conn, events) == ERROR)
+	{
+		return CONNECTION_CLOSE;
+	}
+
+	return CONNECTION_OPEN;
+}
+/*------------------------------------------------------------------------*/
+static int connection_watch(struct event_loop *loop, struct connection *conn, uint32_t events)
+{
+	struct epoll_event event;
+	struct io_uring_sqe *sqe;
+	int status = SUCCESS;
+
+	if(!loop->use_uring)
+	{
+		if(conn->registered && (events == conn->events))
+		{
+			return SUCCESS;
+		}
+		memset(&event, 0, sizeof(event));
+		event.events 	= events;
+		event.data.ptr 	= conn;
+		if(epoll_ctl(loop->epfd, conn->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+						conn->clifd, &event) == ERROR)
+		{
+			async_log(LOG_ERR,"epoll_ctl() failed\n");
+			#if DEBUG
+				printf("epoll_ctl() failed\n");
+			#endif
+			return ERROR;
+		}
+		conn->events = events;
+		conn->registered = true;
+		return SUCCESS;
+	}
+	/*------------------------------------------------------------------------*/
+	//a receive stays armed while reading is wanted, a paused connection
+	//has its receive cancelled so the peer is held back by TCP again
+	if((events & EPOLLIN) && !conn->recv_armed)
+	{
+		sqe = uring_get_sqe(&loop->ring);
+		if(sqe == NULL)
+		{
+			status = ERROR;
+		}
+		else
+		{
+			sqe->opcode 	= IORING_OP_RECV;
+			sqe->fd 		= conn->clifd;
+			sqe->flags 		= IOSQE_BUFFER_SELECT;
+			sqe->buf_group 	= URING_BUFFER_GROUP;
+			sqe->ioprio 	= loop->recv_multishot ? IORING_RECV_MULTISHOT : 0;
+			sqe->user_data 	= (uint64_t) (uintptr_t) conn | URING_OP_RECV;
+			conn->recv_armed = true;
+		}
+	}
+	else if(!(events & EPOLLIN) && conn->recv_armed && !conn->recv_cancelled)
+	{
+		sqe = uring_get_sqe(&loop->ring);
+		if(sqe == NULL)
+		{
+			status = ERROR;
+		}
+		else
+		{
+			sqe->opcode 	= IORING_OP_ASYNC_CANCEL;
+			sqe->addr 		= (uint64_t) (uintptr_t) conn | URING_OP_RECV;
+			sqe->user_data 	= URING_IGNORE;
+			conn->recv_cancelled = true;
+		}
+	}
+
+	if((status == SUCCESS) && (events & EPOLLOUT) && !conn->pollout_armed)
+	{
+		sqe = uring_get_sqe(&loop->ring);
+		if(sqe == NULL)
+		{
+			status = ERROR;
+		}
+		else
+		{
+			sqe->opcode 		= IORING_OP_POLL_ADD;
+			sqe->fd 			= conn->clifd;
+			sqe->poll32_events 	= POLLOUT;
+			sqe->user_data 		= (uint64_t) (uintptr_t) conn | URING_OP_POLLOUT;
+			conn->pollout_armed = true;
+		}
+	}
+
+	if(status == ERROR)
+	{
+		async_log(LOG_ERR,"uring_get_sqe() failed\n");
+		#if DEBUG
+			printf("uring_get_sqe() failed\n");
+		#endif
+		return ERROR;
+	}
+	conn->events = events;
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static int connection_handle_packets(struct connection *conn)
+{
+	struct storage_request *request;
+	struct pending_reply *pending;
+	const char *packet;
+	size_t length, since;
+	bool command, fragment, wants_reply;
+	int packets = 0, status;
+
+	if(conn->read_closed || (conn->reply_count >= MAX_PIPELINED_REPLIES))
+	{
+		return 0;
+	}
+	status = packet_framer_next(&conn->framer, &packet, &length);
+
+	while(status != ERROR)
+	{
+		//the head of an oversized packet is stored on its own, the
+		//packet is answered once its newline arrives
+		fragment = (status == PACKET_FRAGMENT);
+		if(fragment)
+		{
+			if(!config.split_packets)
+			{
+				stats_count(STATS_PACKETS_REJECTED, 1);
+				async_log(LOG_WARNING,"Packet over %zu bytes on fd %d, closing\n", config.max_packet, conn->clifd);
+				#if DEBUG
+					printf("Packet over %zu bytes on fd %d, closing\n", config.max_packet, conn->clifd);
+				#endif
+				return ERROR;
+			}
+			stats_count(STATS_PACKETS_SPLIT, 1);
+		}
+		command = !fragment && connection_parse_since(packet, length, &since);
+		if(command)
+		{
+			length = 0;
+		}
+
+		if(admission_charge(length) == ERROR)
+		{
+			stats_count(STATS_BUDGET_EXCEEDED, 1);
+			async_log(LOG_WARNING,"Memory budget exceeded on fd %d, closing\n", conn->clifd);
+			#if DEBUG
+				printf("Memory budget exceeded on fd %d, closing\n", conn->clifd);
+			#endif
+			return ERROR;
+		}
+		request = storage_request_alloc(packet, length);
+		if(request == NULL)
+		{
+			admission_release(length);
+			return ERROR;
+		}
+		request->done_queue = &conn->loop->completions;
+		request->done_fd 	= conn->loop->donefd;
+		request->context 	= conn;
+		if(command)
+		{
+			conn->incremental 		= true;
+			request->set_since 		= true;
+			request->since_value 	= since;
+		}
+		if(conn->incremental)
+		{
+			request->since = &conn->since;
+		}
+		/*------------------------------------------------------------------------*/
+		//without sessions a single reply answers every packet received
+		//so far, then the connection closes
+		if(config.sessions)
+		{
+			wants_reply = !fragment;
+		}
+		else
+		{
+			status = packet_framer_next(&conn->framer, &packet, &length);
+			wants_reply = !fragment && (status == ERROR);
+		}
+
+		if(wants_reply)
+		{
+			pending = (struct pending_reply *) calloc(1, sizeof(struct pending_reply));
+			if(pending == NULL)
+			{
+				async_log(LOG_ERR,"calloc() failed\n");
+				#if DEBUG
+					printf("calloc() failed\n");
+				#endif
+				admission_release(request->length);
+				free(request);
+				return ERROR;
+			}
+			reply_init(&pending->reply);
+			request->reply = &pending->reply;
+			STAILQ_INSERT_TAIL(&conn->replies, pending, entries);
+			conn->reply_count++;
+			if(!config.sessions)
+			{
+				conn->read_closed = true;
+			}
+		}
+
+		conn->inflight++;
+		storage_writer_submit(request);
+		packets += fragment ? 0 : 1;
+
+		if(config.sessions)
+		{
+			status = (conn->reply_count < MAX_PIPELINED_REPLIES) ?
+						packet_framer_next(&conn->framer, &packet, &length) : ERROR;
+		}
+	}
+	stats_count(STATS_PACKETS, packets);
+
+	return packets;
+}
+/*------------------------------------------------------------------------*/
+static bool connection_parse_since(const char *packet, size_t length, size_t *since)
+{
+	char digits[32];
+	size_t prefix = strlen(SINCE_COMMAND);
+	unsigned long long value;
+	char *end;
+
+	if((length <= prefix) || ((length - prefix) > sizeof(digits)) ||
+		memcmp(packet, SINCE_COMMAND, prefix))
+	{
+		return false;
+	}
+
+	//digits and the newline, copied to terminate them for strtoull()
+	memcpy(digits, packet + prefix, length - prefix);
+	digits[length - prefix - 1] = '\0';
+	errno = 0;
+	value = strtoull(digits, &end, 10);
+	if((end == digits) || (*end != '\0') || (errno != 0))
+	{
+		return false;
+	}
+
+	*since = (size_t) value;
+	return true;
+}
+/*------------------------------------------------------------------------*/
+static void connection_close(struct event_loop *loop, struct connection *conn)
+{
+	struct io_uring_sqe *sqe;
+
+	if(!loop->use_uring)
+	{
+		epoll_ctl(loop->epfd, EPOLL_CTL_DEL, conn->clifd, NULL);
+	}
+	else
+	{
+		//the ring holds its own reference to the socket, outstanding
+		//requests end with -ECANCELED and are reaped before the free
+		if(conn->recv_armed && !conn->recv_cancelled && ((sqe = uring_get_sqe(&loop->ring)) != NULL))
+		{
+			sqe->opcode 	= IORING_OP_ASYNC_CANCEL;
+			sqe->addr 		= (uint64_t) (uintptr_t) conn | URING_OP_RECV;
+			sqe->user_data 	= URING_IGNORE;
+			conn->recv_cancelled = true;
+		}
+		if(conn->pollout_armed && ((sqe = uring_get_sqe(&loop->ring)) != NULL))
+		{
+			sqe->opcode 	= IORING_OP_ASYNC_CANCEL;
+			sqe->addr 		= (uint64_t) (uintptr_t) conn | URING_OP_POLLOUT;
+			sqe->user_data 	= URING_IGNORE;
+		}
+	}
+	LIST_REMOVE(conn, entries);
+	close(conn->clifd);
+	admission_connection_close();
+	stats_count(STATS_CONNECTIONS_CLOSED, 1);
+
+	async_log(LOG_DEBUG,"Closed connection on fd %d", conn->clifd);
+	#if DEBUG
+		printf("Closed connection on fd %d", conn->clifd);
+	#endif
+
+	//replies still at the storage writer must not be freed under it
+	conn->closed = true;
+	connection_release(conn);
+}
+/*------------------------------------------------------------------------*/
+static void connection_free(struct connection *conn)
+{
+	struct pending_reply *pending;
+
+	packet_framer_destroy(&conn->framer);
+	admission_release(conn->charged);
+	while((pending = STAILQ_FIRST(&conn->replies)) != NULL)
+	{
+		STAILQ_REMOVE_HEAD(&conn->replies, entries);
+		reply_release(&pending->reply);
+		free(pending);
+	}
+	free(conn);
+}
+/*------------------------------------------------------------------------*/
+static void connection_release(struct connection *conn)
+{
+	if((conn->inflight == 0) && !conn->recv_armed && !conn->pollout_armed)
+	{
+		connection_free(conn);
+	}
+}
+/*------------------------------------------------------------------------*/
+static bool connection_idle(struct connection *conn)
+{
+	//a single packet connection ends by itself once answered
+	return config.sessions && conn->served && (conn->reply_count == 0) &&
+			(conn->inflight == 0) && (conn->framer.length == conn->framer.start);
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,102 @@
+/*
+ * @filename 		:	event-loop.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						epoll or io_uring based connection engine for
+ *						aesdsocket. A small, fixed number of loop threads
+ *						multiplex every client connection using
+ *						non-blocking sockets. The loops double as the
+ *						worker pool fed from the bounded connection queue.
+ */
+#ifndef EVENT_LOOP_H_
+#define EVENT_LOOP_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	creates the connection queue and the epoll or
+ *					io_uring instances and spawns the worker threads
+ *
+ * @parameters	:	nloops		:	number of worker threads, 0 selects
+ *									one worker per online cpu
+ *					queue_depth	:	number of accepted connections that
+ *									may wait for a worker
+ *					use_uring	:	drive the connections with io_uring,
+ *									falls back to epoll if the kernel
+ *									does not support it
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int event_loop_start(int nloops, size_t queue_depth, bool use_uring);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	queues an accepted client for the worker pool.
+ *					Blocks while the queue is full. Ownership of clifd
+ *					moves to the pool. Safe to call from every
+ *					acceptor thread.
+ *
+ * @parameters	:	clifd	:	accepted client socket, non-blocking
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure (clifd is
+ *					closed)
+ */
+int event_loop_add_connection(int clifd);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	refuses further connections, an acceptor blocked on
+ *					the full queue returns at once. Call before stopping
+ *					the acceptors.
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void event_loop_refuse(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	lets the connections finish, call once the acceptors
+ *					are stopped. Connections complete their packet and
+ *					reply, sessions (-k) are closed as soon as they rest
+ *					between packets.
+ *
+ * @parameters	:	seconds	:	longest wait, connections left then are
+ *								closed by event_loop_stop()
+ *
+ * @returns		:	none
+ */
+void event_loop_drain(unsigned int seconds);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	stops all loop threads and waits for them, nothing is
+ *					read or submitted to the storage writer afterwards.
+ *					Connections stay open until event_loop_stop(), stop
+ *					the storage writer in between so every request
+ *					already submitted is committed.
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void event_loop_halt(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	halts the loops if not done yet, takes back the
+ *					requests the storage writer completed and closes
+ *					every connection still owned by the loops
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void event_loop_stop(void);
+
+#endif /* EVENT_LOOP_H_ */
+/*EOF*/
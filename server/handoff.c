@@ -0,0 +1,383 @@
+/*
+ * @filename 		:	handoff.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Listener handoff between an old and a new server.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#define _GNU_SOURCE				//accept4(), MSG_CMSG_CLOEXEC
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "aesdsocket.h"
+#include "handoff.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define LISTENERS_MESSAGE	"LISTENERS\n"
+#define DONE_MESSAGE		"DONE\n"
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static int			handoff_fd		= ERROR;
+static const char	*handoff_path	= NULL;
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	fills a UNIX socket address
+ *
+ * @parameters	:	address	:	address to fill
+ *					path	:	socket path
+ *
+ * @returns		:	SUCCESS on success, ERROR if path is too long
+ */
+static int handoff_address(struct sockaddr_un *address, const char *path);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	reads from sockfd until the peer closes it
+ *
+ * @parameters	:	sockfd	:	socket to read
+ *
+ * @returns		:	what was read as a string, to be freed, NULL on
+ *					failure
+ */
+static char* handoff_read_all(int sockfd);
+
+/*------------------------------------------------------------------------*/
+int handoff_request(const char *path, int *fds, int max, char **history)
+{
+	struct sockaddr_un address;
+	struct msghdr message;
+	struct cmsghdr *control;
+	struct iovec iov;
+	char buffer[sizeof(LISTENERS_MESSAGE)];
+	char space[CMSG_SPACE(sizeof(int) * HANDOFF_MAX_LISTENERS)];
+	char *answer;
+	ssize_t status;
+	int sockfd, count = 0, i, *received;
+
+	*history = NULL;
+	if(handoff_address(&address, path) == ERROR)
+	{
+		return ERROR;
+	}
+
+	sockfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(sockfd == ERROR)
+	{
+		syslog(LOG_ERR,"socket() failed\n");
+		#if DEBUG
+			printf("socket() failed\n");
+		#endif
+		return ERROR;
+	}
+	if(connect(sockfd, (struct sockaddr *) &address, sizeof(address)) == ERROR)
+	{
+		close(sockfd);
+		if((errno == ENOENT) || (errno == ECONNREFUSED))
+		{
+			syslog(LOG_INFO,"No server to take over at %s\n", path);
+			return 0;
+		}
+		syslog(LOG_ERR,"connect() failed for %s\n", path);
+		#if DEBUG
+			printf("connect() failed for %s\n", path);
+		#endif
+		return ERROR;
+	}
+	/*------------------------------------------------------------------------*/
+	memset(&message, 0, sizeof(message));
+	iov.iov_base 			= buffer;
+	iov.iov_len 			= sizeof(buffer) - 1;
+	message.msg_iov 		= &iov;
+	message.msg_iovlen 		= 1;
+	message.msg_control 	= space;
+	message.msg_controllen 	= sizeof(space);
+	do
+	{
+		status = recvmsg(sockfd, &message, MSG_CMSG_CLOEXEC);
+	} while((status == ERROR) && (errno == EINTR));
+
+	for(control = CMSG_FIRSTHDR(&message); (status > 0) && (control != NULL);
+		control = CMSG_NXTHDR(&message, control))
+	{
+		if((control->cmsg_level == SOL_SOCKET) && (control->cmsg_type == SCM_RIGHTS))
+		{
+			received = (int *) CMSG_DATA(control);
+			for(i = 0; i < (int) ((control->cmsg_len - CMSG_LEN(0)) / sizeof(int)); i++)
+			{
+				if(count < max)
+				{
+					fds[count++] = received[i];
+				}
+				else
+				{
+					close(received[i]);
+				}
+			}
+		}
+	}
+	if((count == 0) || (message.msg_flags & MSG_CTRUNC))
+	{
+		syslog(LOG_ERR,"No listeners received from %s\n", path);
+		#if DEBUG
+			printf("No listeners received from %s\n", path);
+		#endif
+		while(count > 0)
+		{
+			close(fds[--count]);
+		}
+		close(sockfd);
+		return ERROR;
+	}
+	syslog(LOG_INFO,"Received %d listener(s), waiting for the old server to drain\n", count);
+	/*------------------------------------------------------------------------*/
+	//keep the listeners either way, the old server no longer accepts
+	answer = handoff_read_all(sockfd);
+	close(sockfd);
+	if((answer == NULL) || strncmp(answer, DONE_MESSAGE, strlen(DONE_MESSAGE)))
+	{
+		syslog(LOG_WARNING,"Old server ended without handing over its history\n");
+		free(answer);
+		return count;
+	}
+
+	memmove(answer, answer + strlen(DONE_MESSAGE), strlen(answer) - strlen(DONE_MESSAGE) + 1);
+	if(answer[0] == '\0')
+	{
+		free(answer);
+		answer = NULL;
+	}
+	*history = answer;
+	return count;
+}
+/*------------------------------------------------------------------------*/
+int handoff_listen(const char *path)
+{
+	struct sockaddr_un address;
+
+	if(handoff_address(&address, path) == ERROR)
+	{
+		return ERROR;
+	}
+
+	handoff_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(handoff_fd == ERROR)
+	{
+		syslog(LOG_ERR,"socket() failed\n");
+		#if DEBUG
+			printf("socket() failed\n");
+		#endif
+		return ERROR;
+	}
+
+	unlink(path);
+	if((bind(handoff_fd, (struct sockaddr *) &address, sizeof(address)) == ERROR) ||
+		(listen(handoff_fd, HANDOFF_BACKLOG) == ERROR))
+	{
+		syslog(LOG_ERR,"bind()/listen() failed for %s\n", path);
+		#if DEBUG
+			printf("bind()/listen() failed for %s\n", path);
+		#endif
+		close(handoff_fd);
+		handoff_fd = ERROR;
+		return ERROR;
+	}
+	handoff_path = path;
+
+	syslog(LOG_INFO,"Handoff socket listening on %s\n", path);
+	return handoff_fd;
+}
+/*------------------------------------------------------------------------*/
+int handoff_accept(const int *fds, int count)
+{
+	struct msghdr message;
+	struct cmsghdr *control;
+	struct iovec iov;
+	char space[CMSG_SPACE(sizeof(int) * HANDOFF_MAX_LISTENERS)];
+	int successor;
+	ssize_t status;
+
+	successor = accept4(handoff_fd, NULL, NULL, SOCK_CLOEXEC);
+	if(successor == ERROR)
+	{
+		syslog(LOG_ERR,"accept4() failed on the handoff socket\n");
+		#if DEBUG
+			printf("accept4() failed on the handoff socket\n");
+		#endif
+		return ERROR;
+	}
+	/*------------------------------------------------------------------------*/
+	memset(&message, 0, sizeof(message));
+	memset(space, 0, sizeof(space));
+	iov.iov_base 			= LISTENERS_MESSAGE;
+	iov.iov_len 			= strlen(LISTENERS_MESSAGE);
+	message.msg_iov 		= &iov;
+	message.msg_iovlen 		= 1;
+	message.msg_control 	= space;
+	message.msg_controllen 	= CMSG_SPACE(sizeof(int) * count);
+
+	control 				= CMSG_FIRSTHDR(&message);
+	control->cmsg_level 	= SOL_SOCKET;
+	control->cmsg_type 		= SCM_RIGHTS;
+	control->cmsg_len 		= CMSG_LEN(sizeof(int) * count);
+	memcpy(CMSG_DATA(control), fds, sizeof(int) * count);
+
+	status = sendmsg(successor, &message, MSG_NOSIGNAL);
+	if(status != (ssize_t) strlen(LISTENERS_MESSAGE))
+	{
+		syslog(LOG_ERR,"sendmsg() failed on the handoff socket\n");
+		#if DEBUG
+			printf("sendmsg() failed on the handoff socket\n");
+		#endif
+		close(successor);
+		return ERROR;
+	}
+
+	syslog(LOG_INFO,"Handed %d listener(s) to a new server\n", count);
+	return successor;
+}
+/*------------------------------------------------------------------------*/
+void handoff_finish(int successor, const char *history)
+{
+	struct msghdr message;
+	struct iovec iov[2];
+	ssize_t status;
+	int count = (history != NULL) ? 2 : 1;
+
+	memset(&message, 0, sizeof(message));
+	memset(iov, 0, sizeof(iov));
+	iov[0].iov_base = DONE_MESSAGE;
+	iov[0].iov_len 	= strlen(DONE_MESSAGE);
+	if(history != NULL)
+	{
+		iov[1].iov_base = (char *) history;
+		iov[1].iov_len 	= strlen(history);
+	}
+
+	//the successor only reads, a short write is resumed
+	while(count > 0)
+	{
+		message.msg_iov 	= iov;
+		message.msg_iovlen 	= count;
+		status = sendmsg(successor, &message, MSG_NOSIGNAL);
+		if(status == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			syslog(LOG_ERR,"sendmsg() failed on the handoff socket\n");
+			#if DEBUG
+				printf("sendmsg() failed on the handoff socket\n");
+			#endif
+			break;
+		}
+		while((count > 0) && ((size_t) status >= iov[0].iov_len))
+		{
+			status -= iov[0].iov_len;
+			iov[0] = iov[1];
+			count--;
+		}
+		if(count > 0)
+		{
+			iov[0].iov_base = (char *) iov[0].iov_base + status;
+			iov[0].iov_len 	-= status;
+		}
+	}
+	close(successor);
+}
+/*------------------------------------------------------------------------*/
+void handoff_close(void)
+{
+	if(handoff_fd == ERROR)
+	{
+		return;
+	}
+
+	close(handoff_fd);
+	handoff_fd = ERROR;
+	unlink(handoff_path);
+	handoff_path = NULL;
+}
+/*------------------------------------------------------------------------*/
+static int handoff_address(struct sockaddr_un *address, const char *path)
+{
+	memset(address, 0, sizeof(struct sockaddr_un));
+	address->sun_family = AF_UNIX;
+	if(strlen(path) >= sizeof(address->sun_path))
+	{
+		syslog(LOG_ERR,"handoff socket path too long: %s\n", path);
+		#if DEBUG
+			printf("handoff socket path too long: %s\n", path);
+		#endif
+		return ERROR;
+	}
+	strcpy(address->sun_path, path);
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static char* handoff_read_all(int sockfd)
+{
+	char *text = NULL, *grown;
+	size_t length = 0, size = 0;
+	ssize_t status;
+
+	while(true)
+	{
+		if(size - length < BUFFER_SIZE)
+		{
+			size += BUFFER_SIZE;
+			grown = (char *) realloc(text, size + 1);
+			if(grown == NULL)
+			{
+				syslog(LOG_ERR,"realloc() failed\n");
+				#if DEBUG
+					printf("realloc() failed\n");
+				#endif
+				free(text);
+				return NULL;
+			}
+			text = grown;
+		}
+
+		status = read(sockfd, text + length, size - length);
+		if(status == 0)
+		{
+			break;
+		}
+		if(status == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			syslog(LOG_ERR,"read() failed on the handoff socket\n");
+			#if DEBUG
+				printf("read() failed on the handoff socket\n");
+			#endif
+			free(text);
+			return NULL;
+		}
+		length += status;
+	}
+
+	text[length] = '\0';
+	return text;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
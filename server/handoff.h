@@ -0,0 +1,94 @@
+/*
+ * @filename 		:	handoff.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Restart without refusing a client. A server run
+ *						with -H <path> listens on a UNIX socket at path.
+ *						A new server started with the same -H connects
+ *						there first and the two take turns:
+ *
+ *							1.	the old server passes its listeners with
+ *								SCM_RIGHTS and stops accepting, clients
+ *								wait in the accept queues the two share
+ *							2.	the old server drains its connections
+ *								(-G), stops its storage writer and sends
+ *								"DONE" with the storage_describe() text
+ *							3.	the new server opens the storage where
+ *								the old one left it and starts accepting
+ *
+ *						With nobody listening at path the new server
+ *						binds its own listeners, a cold start.
+ */
+#ifndef HANDOFF_H_
+#define HANDOFF_H_
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define HANDOFF_MAX_LISTENERS	(64)		//listeners passed on at most
+#define HANDOFF_BACKLOG			(1)
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	takes over from the server listening at path, if
+ *					any. Blocks until it finished draining.
+ *
+ * @parameters	:	path	:	handoff socket of the running server
+ *					fds		:	filled with the adopted listeners
+ *					max		:	size of fds
+ *					history	:	set to the storage_describe() text of the
+ *								old server, to be freed, NULL if it sent
+ *								none
+ *
+ * @returns		:	number of listeners adopted, 0 for a cold start,
+ *					ERROR on failure
+ */
+int handoff_request(const char *path, int *fds, int max, char **history);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	binds the handoff socket, replacing a stale one
+ *
+ * @parameters	:	path	:	where successors will connect
+ *
+ * @returns		:	the listening socket to poll, ERROR on failure
+ */
+int handoff_listen(const char *path);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	accepts a successor and passes it the listeners.
+ *					The caller keeps serving if this fails.
+ *
+ * @parameters	:	fds		:	listeners, still used by this process
+ *					count	:	number of listeners
+ *
+ * @returns		:	socket to the successor, ERROR on failure
+ */
+int handoff_accept(const int *fds, int count);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	tells the successor it can start and closes the
+ *					connection to it
+ *
+ * @parameters	:	successor	:	socket from handoff_accept()
+ *					history		:	storage_describe() text, NULL makes
+ *									the successor start empty
+ *
+ * @returns		:	none
+ */
+void handoff_finish(int successor, const char *history);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	closes and unlinks the handoff socket, no successor
+ *					can connect afterwards
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void handoff_close(void);
+
+#endif /* HANDOFF_H_ */
+/*EOF*/
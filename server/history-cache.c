@@ -0,0 +1,289 @@
+/*
+ * @filename 		:	history-cache.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Optional in-process copy of the storage history.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+#include "aesdsocket.h"
+#include "history-cache.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static struct history_block	*first_block	= NULL;
+static struct history_block	*last_block		= NULL;
+static size_t				last_count		= 0;	//segments used in last_block
+static size_t				segment_count	= 0;	//segments in the whole history
+static size_t				total_bytes		= 0;
+static size_t				base_bytes		= 0;	//history before the cache started
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	finds the segment holding a byte of the history
+ *
+ * @parameters	:	offset	:	byte to find, below total_bytes
+ *					block	:	set to the block of the segment
+ *					index	:	set to the segment inside that block
+ *
+ * @returns		:	number of segments before the one found
+ */
+static size_t history_cache_locate(size_t offset, struct history_block **block, size_t *index);
+
+/*------------------------------------------------------------------------*/
+int history_cache_append(const char *data, size_t length)
+{
+	struct history_block *block;
+	char *copy;
+
+	copy = (char *) malloc(length);
+	if(copy == NULL)
+	{
+		async_log(LOG_ERR,"malloc() failed\n");
+		#if DEBUG
+			printf("malloc() failed\n");
+		#endif
+		return ERROR;
+	}
+	memcpy(copy, data, length);
+	/*------------------------------------------------------------------------*/
+	if((last_block == NULL) || (last_count == HISTORY_BLOCK_SEGMENTS))
+	{
+		block = (struct history_block *) calloc(1, sizeof(struct history_block));
+		if(block == NULL)
+		{
+			async_log(LOG_ERR,"calloc() failed\n");
+			#if DEBUG
+				printf("calloc() failed\n");
+			#endif
+			free(copy);
+			return ERROR;
+		}
+
+		if(last_block == NULL)
+		{
+			first_block = block;
+		}
+		else
+		{
+			last_block->next = block;
+		}
+		last_block = block;
+		last_count = 0;
+	}
+	/*------------------------------------------------------------------------*/
+	last_block->segments[last_count].data 	= copy;
+	last_block->segments[last_count].length = length;
+	last_block->segments[last_count].start 	= total_bytes;
+	last_count++;
+	segment_count++;
+	total_bytes += length;
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+void history_cache_snapshot(struct history_cursor *cursor, size_t since, size_t end)
+{
+	struct history_block *block;
+	size_t first, last, index;
+
+	memset(cursor, 0, sizeof(struct history_cursor));
+	if(end > total_bytes)
+	{
+		end = total_bytes;
+	}
+	if(since < base_bytes)
+	{
+		since = base_bytes;
+	}
+	if(since >= end)
+	{
+		return;
+	}
+
+	//end is a boundary, the segment starting there is the first one left out
+	last = (end == total_bytes) ? segment_count : history_cache_locate(end, &block, &index);
+	first = history_cache_locate(since, &block, &index);
+
+	cursor->block 		= block;
+	cursor->index 		= index;
+	cursor->offset 		= since - block->segments[index].start;
+	cursor->remaining 	= last - first;
+
+	//taken under mutex_lock, history_cache_trim() cannot free the block
+	__atomic_add_fetch(&block->refs, 1, __ATOMIC_RELAXED);
+}
+/*------------------------------------------------------------------------*/
+int history_cursor_fill_iov(const struct history_cursor *cursor, struct iovec *iov, int max_iov)
+{
+	struct history_block *block = cursor->block;
+	size_t index 	= cursor->index;
+	size_t offset 	= cursor->offset;
+	size_t left 	= cursor->remaining;
+	int count 		= 0;
+
+	while((left > 0) && (count < max_iov))
+	{
+		iov[count].iov_base = block->segments[index].data + offset;
+		iov[count].iov_len 	= block->segments[index].length - offset;
+		count++;
+		left--;
+		offset = 0;
+
+		if(++index == HISTORY_BLOCK_SEGMENTS)
+		{
+			block = block->next;
+			index = 0;
+		}
+	}
+
+	return count;
+}
+/*------------------------------------------------------------------------*/
+void history_cursor_advance(struct history_cursor *cursor, size_t bytes)
+{
+	struct history_block *block;
+	size_t left;
+
+	while((bytes > 0) && (cursor->remaining > 0))
+	{
+		left = cursor->block->segments[cursor->index].length - cursor->offset;
+		if(bytes < left)
+		{
+			cursor->offset += bytes;
+			return;
+		}
+
+		bytes -= left;
+		cursor->offset = 0;
+		if(--cursor->remaining == 0)
+		{
+			history_cursor_release(cursor);
+			return;
+		}
+		if(++cursor->index == HISTORY_BLOCK_SEGMENTS)
+		{
+			//the next block is referenced before this one is let go,
+			//trimming never gets past a block a cursor is in
+			block = cursor->block;
+			cursor->block = block->next;
+			cursor->index = 0;
+			__atomic_add_fetch(&cursor->block->refs, 1, __ATOMIC_RELAXED);
+			__atomic_sub_fetch(&block->refs, 1, __ATOMIC_RELEASE);
+		}
+	}
+}
+/*------------------------------------------------------------------------*/
+void history_cursor_release(struct history_cursor *cursor)
+{
+	if(cursor->block != NULL)
+	{
+		__atomic_sub_fetch(&cursor->block->refs, 1, __ATOMIC_RELEASE);
+	}
+	memset(cursor, 0, sizeof(struct history_cursor));
+}
+/*------------------------------------------------------------------------*/
+void history_cache_trim(size_t before)
+{
+	struct history_block *block;
+	size_t i;
+
+	//the last block is still appended to and always kept
+	while((first_block != last_block) && (first_block->next->segments[0].start <= before) &&
+			(__atomic_load_n(&first_block->refs, __ATOMIC_ACQUIRE) == 0))
+	{
+		block = first_block;
+		first_block = block->next;
+		for(i = 0; i < HISTORY_BLOCK_SEGMENTS; i++)
+		{
+			free(block->segments[i].data);
+		}
+		free(block);
+
+		segment_count 	-= HISTORY_BLOCK_SEGMENTS;
+		base_bytes 		= first_block->segments[0].start;
+	}
+}
+/*------------------------------------------------------------------------*/
+static size_t history_cache_locate(size_t offset, struct history_block **block, size_t *index)
+{
+	struct history_block *found = first_block;
+	size_t skipped = 0, low, high, middle, used;
+
+	while((found->next != NULL) && (found->next->segments[0].start <= offset))
+	{
+		found = found->next;
+		skipped += HISTORY_BLOCK_SEGMENTS;
+	}
+
+	//last segment of the block starting at or before offset
+	used = (found == last_block) ? last_count : HISTORY_BLOCK_SEGMENTS;
+	low = 0;
+	high = used - 1;
+	while(low < high)
+	{
+		middle = (low + high + 1) / 2;
+		if(found->segments[middle].start <= offset)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	*block = found;
+	*index = low;
+	return skipped + low;
+}
+/*------------------------------------------------------------------------*/
+void history_cache_start(size_t base)
+{
+	total_bytes = base;
+	base_bytes 	= base;
+}
+/*------------------------------------------------------------------------*/
+size_t history_cache_size(void)
+{
+	return total_bytes;
+}
+/*------------------------------------------------------------------------*/
+void history_cache_destroy(void)
+{
+	struct history_block *block;
+	size_t i, used;
+
+	while(first_block != NULL)
+	{
+		block = first_block;
+		first_block = block->next;
+
+		used = (block == last_block) ? last_count : HISTORY_BLOCK_SEGMENTS;
+		for(i = 0; i < used; i++)
+		{
+			free(block->segments[i].data);
+		}
+		free(block);
+	}
+
+	last_block 		= NULL;
+	last_count 		= 0;
+	segment_count 	= 0;
+	total_bytes 	= 0;
+	base_bytes 		= 0;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,164 @@
+/*
+ * @filename 		:	history-cache.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Optional in-process copy of the storage history.
+ *						Every packet becomes an immutable segment in an
+ *						append-only list of fixed size blocks, so replies
+ *						can be gathered into an iovec and sent without
+ *						reading the storage back. Blocks never move once
+ *						published, a cursor taken under mutex_lock stays
+ *						valid after the lock is released.
+ *
+ *						With a retention limit the oldest blocks are
+ *						freed once the history they hold has expired. A
+ *						cursor holds a reference on its block, trimming
+ *						stops at the first block still referenced and
+ *						retries on the next append.
+ */
+#ifndef HISTORY_CACHE_H_
+#define HISTORY_CACHE_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <sys/uio.h>
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define HISTORY_BLOCK_SEGMENTS	(1024)
+
+/*------------------------------------------------------------------------*/
+/*							CACHE STRUCTURES							  */
+/*------------------------------------------------------------------------*/
+struct history_segment
+{
+	char *data;
+	size_t length;
+	size_t start;			//offset of the segment in the history
+};
+
+struct history_block
+{
+	struct history_segment segments[HISTORY_BLOCK_SEGMENTS];
+	struct history_block *next;
+	unsigned int refs;		//cursors positioned in this block
+};
+
+//position inside a snapshot of the history
+struct history_cursor
+{
+	struct history_block *block;
+	size_t index;			//segment inside block
+	size_t offset;			//byte inside that segment
+	size_t remaining;		//segments left, including the current one,
+							//block is referenced while it is not 0
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	copies a packet into a new segment at the end of the
+ *					history. The caller must hold mutex_lock.
+ *
+ * @parameters	:	data	:	packet to copy
+ *					length	:	size of the packet
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int history_cache_append(const char *data, size_t length);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	positions cursor on the bytes [since, end) of the
+ *					history, O(blocks + log HISTORY_BLOCK_SEGMENTS).
+ *					The caller must hold mutex_lock, the cursor may be
+ *					used after the lock is released.
+ *
+ * @parameters	:	cursor	:	cursor to fill
+ *					since	:	first byte to send, 0 for everything
+ *					end		:	end of the snapshot, at a segment boundary
+ *
+ * @returns		:	none
+ */
+void history_cache_snapshot(struct history_cursor *cursor, size_t since, size_t end);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	describes up to max_iov segments starting at the
+ *					cursor, ready for writev()/sendmsg()
+ *
+ * @parameters	:	cursor	:	position to start from
+ *					iov		:	array to fill
+ *					max_iov	:	size of iov
+ *
+ * @returns		:	number of entries filled, 0 once the cursor is done
+ */
+int history_cursor_fill_iov(const struct history_cursor *cursor, struct iovec *iov, int max_iov);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	moves the cursor forward by bytes that were sent
+ *
+ * @parameters	:	cursor	:	cursor to move
+ *					bytes	:	number of bytes consumed
+ *
+ * @returns		:	none
+ */
+void history_cursor_advance(struct history_cursor *cursor, size_t bytes);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	drops the reference of a cursor that is not used to
+ *					the end, e.g. for a connection closed mid-reply
+ *
+ * @parameters	:	cursor	:	cursor to release, may be done already
+ *
+ * @returns		:	none
+ */
+void history_cursor_release(struct history_cursor *cursor);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	frees the oldest blocks that only hold history below
+ *					before and no cursor is positioned in. Snapshots
+ *					start at the first byte kept. The caller must hold
+ *					mutex_lock.
+ *
+ * @parameters	:	before	:	first byte of history still retained
+ *
+ * @returns		:	none
+ */
+void history_cache_trim(size_t before);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	starts an empty history at byte base instead of 0,
+ *					for a history continued from a predecessor process.
+ *					Snapshots below base start at base.
+ *
+ * @parameters	:	base	:	offset of the first byte appended
+ *
+ * @returns		:	none
+ */
+void history_cache_start(size_t base);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	number of bytes held by the history. The caller must
+ *					hold mutex_lock.
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	size of the history in bytes
+ */
+size_t history_cache_size(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	frees every segment and block of the history
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void history_cache_destroy(void);
+
+#endif /* HISTORY_CACHE_H_ */
+/*EOF*/
@@ -0,0 +1,75 @@
+/*
+ * @filename 		:	mpsc-queue.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Lock-free multi-producer single-consumer queue.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include "mpsc-queue.h"
+
+/*------------------------------------------------------------------------*/
+void mpsc_queue_init(struct mpsc_queue *queue)
+{
+	queue->stub.next 	= NULL;
+	queue->head 		= &queue->stub;
+	queue->tail 		= &queue->stub;
+}
+/*------------------------------------------------------------------------*/
+void mpsc_queue_push(struct mpsc_queue *queue, struct mpsc_node *node)
+{
+	struct mpsc_node *previous;
+
+	__atomic_store_n(&node->next, NULL, __ATOMIC_RELAXED);
+	previous = __atomic_exchange_n(&queue->head, node, __ATOMIC_ACQ_REL);
+	//until this store the consumer cannot reach node
+	__atomic_store_n(&previous->next, node, __ATOMIC_RELEASE);
+}
+/*------------------------------------------------------------------------*/
+struct mpsc_node* mpsc_queue_pop(struct mpsc_queue *queue)
+{
+	struct mpsc_node *tail = queue->tail;
+	struct mpsc_node *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+	if(tail == &queue->stub)
+	{
+		if(next == NULL)
+		{
+			return NULL;
+		}
+		queue->tail = next;
+		tail = next;
+		next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	}
+	if(next != NULL)
+	{
+		queue->tail = next;
+		return tail;
+	}
+	/*------------------------------------------------------------------------*/
+	//tail is the last node, or a producer is between its exchange and
+	//linking its node behind tail
+	if(tail != __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+	{
+		return NULL;
+	}
+	mpsc_queue_push(queue, &queue->stub);
+
+	next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+	if(next != NULL)
+	{
+		queue->tail = next;
+		return tail;
+	}
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+bool mpsc_queue_empty(struct mpsc_queue *queue)
+{
+	return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == queue->tail;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
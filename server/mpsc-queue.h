@@ -0,0 +1,87 @@
+/*
+ * @filename 		:	mpsc-queue.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Intrusive lock-free multi-producer single-consumer
+ *						queue (Vyukov). Producers never block or retry, a
+ *						push is one atomic exchange and one store. The
+ *						consumer may briefly see an empty queue while a
+ *						push is half done, producers therefore wake the
+ *						consumer only after their push completed.
+ */
+#ifndef MPSC_QUEUE_H_
+#define MPSC_QUEUE_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+//structure holding an embedded node
+#define mpsc_entry(node, type, member)	\
+	((type *) ((char *) (node) - offsetof(type, member)))
+
+/*------------------------------------------------------------------------*/
+/*							QUEUE STRUCTURES							  */
+/*------------------------------------------------------------------------*/
+struct mpsc_node
+{
+	struct mpsc_node *next;
+};
+
+struct mpsc_queue
+{
+	struct mpsc_node *head;		//last pushed node, shared by producers
+	struct mpsc_node *tail;		//next node to pop, consumer only
+	struct mpsc_node stub;
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	initializes an empty queue
+ *
+ * @parameters	:	queue	:	queue to initialize
+ *
+ * @returns		:	none
+ */
+void mpsc_queue_init(struct mpsc_queue *queue);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	appends a node, safe from any number of threads
+ *
+ * @parameters	:	queue	:	queue to push to
+ *					node	:	node embedded in the queued structure
+ *
+ * @returns		:	none
+ */
+void mpsc_queue_push(struct mpsc_queue *queue, struct mpsc_node *node);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	removes the oldest node, consumer thread only
+ *
+ * @parameters	:	queue	:	queue to pop from
+ *
+ * @returns		:	the node, NULL if the queue is empty or a push is
+ *					still in progress
+ */
+struct mpsc_node* mpsc_queue_pop(struct mpsc_queue *queue);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	whether anything was pushed and not popped yet,
+ *					consumer thread only
+ *
+ * @parameters	:	queue	:	queue to check
+ *
+ * @returns		:	true if the queue is empty
+ */
+bool mpsc_queue_empty(struct mpsc_queue *queue);
+
+#endif /* MPSC_QUEUE_H_ */
+/*EOF*/
@@ -0,0 +1,145 @@
+/*
+ * @filename 		:	packet-framer.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Reusable newline framing for byte streams.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+#include "aesdsocket.h"
+#include "packet-framer.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+void packet_framer_init(struct packet_framer *framer, size_t limit)
+{
+	memset(framer, 0, sizeof(struct packet_framer));
+	framer->limit = limit;
+}
+/*------------------------------------------------------------------------*/
+char* packet_framer_reserve(struct packet_framer *framer, size_t min_space, size_t *available)
+{
+	size_t size;
+	char *buffer;
+
+	//drop the packets already handed out, only the tail of an
+	//incomplete packet is moved, so every byte moves at most once
+	if(framer->start > 0)
+	{
+		framer->length 	-= framer->start;
+		framer->scanned -= framer->start;
+		memmove(framer->buffer, framer->buffer + framer->start, framer->length);
+		framer->start 	 = 0;
+	}
+	/*------------------------------------------------------------------------*/
+	size = packet_framer_capacity(framer, min_space);
+	if(size != framer->size)
+	{
+		buffer = (char *) realloc(framer->buffer, size);
+		if(buffer == NULL)
+		{
+			async_log(LOG_ERR,"realloc() failed\n");
+			#if DEBUG
+				printf("realloc() failed\n");
+			#endif
+			return NULL;
+		}
+		framer->buffer 	= buffer;
+		framer->size 	= size;
+	}
+
+	*available = framer->size - framer->length;
+	return framer->buffer + framer->length;
+}
+/*------------------------------------------------------------------------*/
+size_t packet_framer_capacity(const struct packet_framer *framer, size_t min_space)
+{
+	size_t size, length;
+
+	//bytes of packets already handed out are dropped before growing
+	length = framer->length - framer->start;
+	if((framer->size - length) >= min_space)
+	{
+		return framer->size;
+	}
+
+	size = (framer->size == 0) ? BUFFER_SIZE : framer->size;
+	while((size - length) < min_space)
+	{
+		size *= 2;
+	}
+	return size;
+}
+/*------------------------------------------------------------------------*/
+void packet_framer_commit(struct packet_framer *framer, size_t received)
+{
+	framer->length += received;
+}
+/*------------------------------------------------------------------------*/
+int packet_framer_next(struct packet_framer *framer, const char **packet, size_t *length)
+{
+	char *newline = NULL;
+	size_t pending;
+
+	if(framer->scanned < framer->length)
+	{
+		newline = memchr(framer->buffer + framer->scanned, '\n', framer->length - framer->scanned);
+		if(newline == NULL)
+		{
+			framer->scanned = framer->length;
+		}
+	}
+	/*------------------------------------------------------------------------*/
+	//a packet without its newline at the limit can only get longer
+	if(framer->limit > 0)
+	{
+		pending = (newline != NULL) ? (size_t)(newline - framer->buffer) + 1 - framer->start
+									: framer->length - framer->start;
+		if((pending > framer->limit) || ((newline == NULL) && (pending == framer->limit)))
+		{
+			*packet = framer->buffer + framer->start;
+			*length = framer->limit;
+
+			framer->start += framer->limit;
+			if(framer->scanned < framer->start)
+			{
+				framer->scanned = framer->start;
+			}
+			return PACKET_FRAGMENT;
+		}
+	}
+
+	if(newline == NULL)
+	{
+		return ERROR;
+	}
+
+	*packet = framer->buffer + framer->start;
+	*length = (size_t)(newline - *packet) + 1;
+
+	framer->start 	= (size_t)(newline - framer->buffer) + 1;
+	framer->scanned = framer->start;
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+size_t packet_framer_pending(const struct packet_framer *framer)
+{
+	return framer->length - framer->start;
+}
+/*------------------------------------------------------------------------*/
+void packet_framer_destroy(struct packet_framer *framer)
+{
+	free(framer->buffer);
+	memset(framer, 0, sizeof(struct packet_framer));
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,137 @@
+/*
+ * @filename 		:	packet-framer.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Reusable newline framing for byte streams. Data is
+ *						received straight into a geometrically growing
+ *						buffer, only the newly received bytes are scanned
+ *						for '\n', and the contents are treated as binary,
+ *						so assembling a packet of n bytes costs O(n).
+ *
+ *						Usage:
+ *							ptr = packet_framer_reserve(&framer, min, &avail);
+ *							received = recv(fd, ptr, avail, 0);
+ *							packet_framer_commit(&framer, received);
+ *							while(packet_framer_next(&framer, &pkt, &len) == SUCCESS)
+ *								handle(pkt, len);
+ *
+ *						A framer created with a limit never assembles a
+ *						packet longer than the limit, the head of a longer
+ *						packet is handed out in limit sized fragments as
+ *						soon as it is received, so the buffer stays
+ *						O(limit) however long the client omits '\n'.
+ */
+#ifndef PACKET_FRAMER_H_
+#define PACKET_FRAMER_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stddef.h>
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+//returned by packet_framer_next() for a fragment of an oversized packet
+#define PACKET_FRAGMENT		(1)
+
+/*------------------------------------------------------------------------*/
+/*							FRAMER STRUCTURE							  */
+/*------------------------------------------------------------------------*/
+struct packet_framer
+{
+	char *buffer;
+	size_t size;			//bytes allocated for buffer
+	size_t length;			//bytes received and not yet discarded
+	size_t start;			//first byte of the packet being assembled
+	size_t scanned;			//bytes before this index hold no unseen '\n'
+	size_t limit;			//longest packet assembled, 0 = unlimited
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	initializes an empty framer, no memory is allocated
+ *					until the first call to packet_framer_reserve()
+ *
+ * @parameters	:	framer	:	framer to initialize
+ *					limit	:	longest packet in bytes, 0 for no limit
+ *
+ * @returns		:	none
+ */
+void packet_framer_init(struct packet_framer *framer, size_t limit);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	makes room for at least min_space more bytes. Bytes
+ *					of packets already returned by packet_framer_next()
+ *					are discarded first, so pointers obtained from it
+ *					become invalid.
+ *
+ * @parameters	:	framer		:	framer to grow
+ *					min_space	:	minimum number of free bytes
+ *					available	:	filled with the number of free bytes
+ *
+ * @returns		:	pointer to the free space, NULL on allocation failure
+ */
+char* packet_framer_reserve(struct packet_framer *framer, size_t min_space, size_t *available);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	size the buffer has after packet_framer_reserve() is
+ *					called with min_space, so the growth can be accounted
+ *					for before it is allocated
+ *
+ * @parameters	:	framer		:	framer to query
+ *					min_space	:	minimum number of free bytes
+ *
+ * @returns		:	buffer size in bytes
+ */
+size_t packet_framer_capacity(const struct packet_framer *framer, size_t min_space);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	accounts for bytes written into the space returned
+ *					by packet_framer_reserve()
+ *
+ * @parameters	:	framer		:	framer that was written to
+ *					received	:	number of bytes written
+ *
+ * @returns		:	none
+ */
+void packet_framer_commit(struct packet_framer *framer, size_t received);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	returns the next complete packet, including its
+ *					terminating '\n'. The packet stays valid until the
+ *					next call to packet_framer_reserve().
+ *
+ * @parameters	:	framer	:	framer to search
+ *					packet	:	filled with the start of the packet
+ *					length	:	filled with the length of the packet
+ *
+ * @returns		:	SUCCESS if a packet was found, PACKET_FRAGMENT for
+ *					the next limit bytes of a packet longer than the
+ *					limit, ERROR otherwise
+ */
+int packet_framer_next(struct packet_framer *framer, const char **packet, size_t *length);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	number of bytes of the incomplete packet held
+ *
+ * @parameters	:	framer	:	framer to query
+ *
+ * @returns		:	pending byte count
+ */
+size_t packet_framer_pending(const struct packet_framer *framer);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	frees the buffer and resets the framer
+ *
+ * @parameters	:	framer	:	framer to destroy
+ *
+ * @returns		:	none
+ */
+void packet_framer_destroy(struct packet_framer *framer);
+
+#endif /* PACKET_FRAMER_H_ */
+/*EOF*/
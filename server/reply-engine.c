@@ -0,0 +1,250 @@
+/*
+ * @filename 		:	reply-engine.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Streams the storage history back to a client.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+
+#include "aesdsocket.h"
+#include "reply-engine.h"
+#include "server-stats.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+void reply_init(struct reply *reply)
+{
+	memset(reply, 0, sizeof(struct reply));
+	reply->srcfd = ERROR;
+}
+/*------------------------------------------------------------------------*/
+struct reply_file* reply_file_create(int fd, size_t start)
+{
+	struct reply_file *file;
+
+	file = (struct reply_file *) malloc(sizeof(struct reply_file));
+	if(file == NULL)
+	{
+		async_log(LOG_ERR,"malloc() failed\n");
+		#if DEBUG
+			printf("malloc() failed\n");
+		#endif
+		return NULL;
+	}
+	file->fd 	= fd;
+	file->start = start;
+	file->next 	= NULL;
+	file->refs 	= 1;
+	return file;
+}
+/*------------------------------------------------------------------------*/
+void reply_file_link(struct reply_file *file, struct reply_file *next)
+{
+	__atomic_add_fetch(&next->refs, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&file->next, next, __ATOMIC_RELEASE);
+}
+/*------------------------------------------------------------------------*/
+void reply_file_put(struct reply_file *file)
+{
+	struct reply_file *next;
+
+	//iterative, dropping the oldest segment may free a long chain
+	while((file != NULL) && (__atomic_sub_fetch(&file->refs, 1, __ATOMIC_ACQ_REL) == 0))
+	{
+		next = __atomic_load_n(&file->next, __ATOMIC_ACQUIRE);
+		close(file->fd);
+		free(file);
+		file = next;
+	}
+}
+/*------------------------------------------------------------------------*/
+void reply_open_file(struct reply *reply, struct reply_file *file)
+{
+	//segments are only ever appended to, so the bytes below the
+	//snapshot cannot change while they are streamed without the lock
+	__atomic_add_fetch(&file->refs, 1, __ATOMIC_RELAXED);
+	reply->file = file;
+}
+/*------------------------------------------------------------------------*/
+int reply_open_stream(struct reply *reply, const char *path)
+{
+	reply->srcfd = open(path, O_RDONLY | O_CLOEXEC);
+	if(reply->srcfd == ERROR)
+	{
+		async_log(LOG_ERR,"open() failed (read only)\n");
+		#if DEBUG
+			printf("open() failed (read only)\n");
+		#endif
+		return ERROR;
+	}
+
+	reply->buffer = (char *) malloc(REPLY_CHUNK_SIZE);
+	if(reply->buffer == NULL)
+	{
+		async_log(LOG_ERR,"malloc() failed\n");
+		#if DEBUG
+			printf("malloc() failed\n");
+		#endif
+		return ERROR;
+	}
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int reply_send(struct reply *reply, int sockfd)
+{
+	struct iovec iov[REPLY_MAX_IOV];
+	struct msghdr message;
+	struct reply_file *next;
+	ssize_t sent, received;
+	off_t position, limit;
+
+	while((reply->file != NULL) && (reply->offset < reply->end))
+	{
+		//every segment but the newest one ends where the next starts
+		limit 	= reply->end;
+		next 	= __atomic_load_n(&reply->file->next, __ATOMIC_ACQUIRE);
+		if((next != NULL) && ((off_t) next->start < limit))
+		{
+			limit = (off_t) next->start;
+		}
+		if(reply->offset >= limit)
+		{
+			__atomic_add_fetch(&next->refs, 1, __ATOMIC_RELAXED);
+			reply_file_put(reply->file);
+			reply->file = next;
+			continue;
+		}
+
+		position 	= reply->offset - (off_t) reply->file->start;
+		sent 		= sendfile(sockfd, reply->file->fd, &position, limit - reply->offset);
+		if(sent == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			{
+				return REPLY_AGAIN;
+			}
+			async_log(LOG_ERR,"sendfile() failed\n");
+			#if DEBUG
+				printf("sendfile() failed\n");
+			#endif
+			return ERROR;
+		}
+		if(sent == 0)
+		{
+			//file shrank underneath us (storage removed on exit)
+			return ERROR;
+		}
+		reply->offset += sent;
+		stats_count(STATS_BYTES_OUT, sent);
+	}
+	/*------------------------------------------------------------------------*/
+	while(reply->srcfd != ERROR)
+	{
+		if(reply->sent == reply->length)
+		{
+			received = read(reply->srcfd, reply->buffer, REPLY_CHUNK_SIZE);
+			if(received == ERROR)
+			{
+				if(errno == EINTR)
+				{
+					continue;
+				}
+				async_log(LOG_ERR,"read() failed!\n");
+				#if DEBUG
+					printf("read() failed!\n");
+				#endif
+				return ERROR;
+			}
+			if(received == 0)
+			{
+				close(reply->srcfd);
+				reply->srcfd = ERROR;
+				break;
+			}
+			reply->length 	= received;
+			reply->sent 	= 0;
+		}
+
+		sent = send(sockfd, reply->buffer + reply->sent, reply->length - reply->sent, MSG_NOSIGNAL);
+		if(sent == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			{
+				return REPLY_AGAIN;
+			}
+			async_log(LOG_ERR,"send() failed\n");
+			#if DEBUG
+				printf("send() failed\n");
+			#endif
+			return ERROR;
+		}
+		reply->sent += sent;
+		stats_count(STATS_BYTES_OUT, sent);
+	}
+	/*------------------------------------------------------------------------*/
+	while(reply->cursor.remaining > 0)
+	{
+		memset(&message, 0, sizeof(message));
+		message.msg_iov 	= iov;
+		message.msg_iovlen 	= history_cursor_fill_iov(&reply->cursor, iov, REPLY_MAX_IOV);
+
+		sent = sendmsg(sockfd, &message, MSG_NOSIGNAL);
+		if(sent == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			if((errno == EAGAIN) || (errno == EWOULDBLOCK))
+			{
+				return REPLY_AGAIN;
+			}
+			async_log(LOG_ERR,"sendmsg() failed\n");
+			#if DEBUG
+				printf("sendmsg() failed\n");
+			#endif
+			return ERROR;
+		}
+		history_cursor_advance(&reply->cursor, sent);
+		stats_count(STATS_BYTES_OUT, sent);
+	}
+
+	return REPLY_DONE;
+}
+/*------------------------------------------------------------------------*/
+void reply_release(struct reply *reply)
+{
+	if(reply->srcfd != ERROR)
+	{
+		close(reply->srcfd);
+	}
+	reply_file_put(reply->file);
+	history_cursor_release(&reply->cursor);
+	free(reply->buffer);
+	reply_init(reply);
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,164 @@
+/*
+ * @filename 		:	reply-engine.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Streams the storage history back to a client.
+ *						Regular files are sent with sendfile() straight
+ *						from the page cache, anything else (the aesdchar
+ *						device) is read in REPLY_CHUNK_SIZE blocks, so a
+ *						reply costs O(size / REPLY_CHUNK_SIZE) syscalls.
+ *
+ *						The file backend keeps its history in a chain of
+ *						segment files. A reply pins the segment it starts
+ *						in and walks the chain up to its end, so segments
+ *						dropped by retention stay readable until the last
+ *						reply using them is done.
+ *						With the history cache enabled the reply is
+ *						gathered from memory and sent with sendmsg().
+ *
+ *						Only the snapshot (history length or cache
+ *						cursor) is taken under mutex_lock by the storage
+ *						backend, all storage reads and sends happen after
+ *						it is released.
+ */
+#ifndef REPLY_ENGINE_H_
+#define REPLY_ENGINE_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "history-cache.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define REPLY_CHUNK_SIZE	(64 * 1024)
+#define REPLY_MAX_IOV		(1024)		//UIO_MAXIOV of the kernel
+
+//return values of reply_send()
+#define REPLY_DONE			(0)
+#define REPLY_AGAIN			(1)
+
+/*------------------------------------------------------------------------*/
+/*							REPLY STRUCTURES							  */
+/*------------------------------------------------------------------------*/
+//one segment file of the history, shared by every reply streaming it
+struct reply_file
+{
+	int fd;						//readable, only ever appended to
+	size_t start;				//history offset of the first byte
+	struct reply_file *next;	//newer segment, set once when it is created
+	unsigned int refs;			//the storage, the older segment and replies
+};
+
+struct reply
+{
+	int srcfd;				//storage being streamed, -1 if unused
+	struct reply_file *file;	//segment sent with sendfile(), NULL if unused
+	off_t offset;			//next history offset to send, set by the snapshot
+	off_t end;				//history length captured under mutex_lock
+	char *buffer;			//REPLY_CHUNK_SIZE bounce buffer for other storage
+	size_t length;			//bytes held in buffer
+	size_t sent;			//bytes of buffer already sent
+	struct history_cursor cursor;	//cached segments still to send
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	initializes an empty reply
+ *
+ * @parameters	:	reply	:	reply to initialize
+ *
+ * @returns		:	none
+ */
+void reply_init(struct reply *reply);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	creates a segment holding one reference for the
+ *					caller
+ *
+ * @parameters	:	fd		:	readable segment file, owned from now on
+ *					start	:	history offset of its first byte
+ *
+ * @returns		:	the segment, NULL on failure
+ */
+struct reply_file* reply_file_create(int fd, size_t start);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	links a newer segment after file, the link holds a
+ *					reference to it
+ *
+ * @parameters	:	file	:	newest segment so far
+ *					next	:	segment following it
+ *
+ * @returns		:	none
+ */
+void reply_file_link(struct reply_file *file, struct reply_file *next);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	drops a reference. The last one closes the segment
+ *					and drops its reference on the next one.
+ *
+ * @parameters	:	file	:	segment, may be NULL
+ *
+ * @returns		:	none
+ */
+void reply_file_put(struct reply_file *file);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	sends the snapshot with sendfile() starting in file
+ *					and following the chain up to reply->end, the
+ *					history length captured when the client's packet
+ *					was appended. The caller must hold mutex_lock, the
+ *					reference taken keeps the segments alive after it
+ *					is released.
+ *
+ * @parameters	:	reply	:	reply filled by the snapshot
+ *					file	:	segment holding reply->offset
+ *
+ * @returns		:	none
+ */
+void reply_open_file(struct reply *reply, struct reply_file *file);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	opens storage that only holds its most recent
+ *					entries (aesdchar) to be streamed until end of file
+ *					through a REPLY_CHUNK_SIZE bounce buffer. Must be
+ *					called without holding mutex_lock.
+ *
+ * @parameters	:	reply	:	reply to fill
+ *					path	:	storage to reply with
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int reply_open_stream(struct reply *reply, const char *path);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	sends as much of the reply as sockfd accepts
+ *
+ * @parameters	:	reply	:	reply to send
+ *					sockfd	:	client socket, may be non-blocking
+ *
+ * @returns		:	REPLY_DONE once everything is sent, REPLY_AGAIN if
+ *					the socket would block, ERROR on failure
+ */
+int reply_send(struct reply *reply, int sockfd);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	closes and frees everything held by the reply
+ *
+ * @parameters	:	reply	:	reply to release
+ *
+ * @returns		:	none
+ */
+void reply_release(struct reply *reply);
+
+#endif /* REPLY_ENGINE_H_ */
+/*EOF*/
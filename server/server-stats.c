@@ -0,0 +1,383 @@
+/*
+ * @filename 		:	server-stats.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Per-thread counters and latency histograms.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+#include "aesdsocket.h"
+#include "server-stats.h"
+#include "admission.h"
+#include "acceptor.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define STATS_SUB_BITS		(4)
+#define STATS_SUB_BUCKETS	(1 << STATS_SUB_BITS)
+#define STATS_BUCKETS		((64 - STATS_SUB_BITS + 1) * STATS_SUB_BUCKETS)
+#define STATS_NAME_SIZE		(16)
+
+//only the owning thread writes, readers may run concurrently
+#define STATS_ADD(field, amount)	\
+	__atomic_store_n(&(field), (field) + (amount), __ATOMIC_RELAXED)
+#define STATS_READ(field)			\
+	__atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+/*------------------------------------------------------------------------*/
+/*							STATS STRUCTURES							  */
+/*------------------------------------------------------------------------*/
+struct stats_histogram
+{
+	uint64_t buckets[STATS_BUCKETS];
+	uint64_t count;
+	uint64_t total;				//nanoseconds
+	uint64_t max;
+};
+
+struct stats_thread
+{
+	char name[STATS_NAME_SIZE];
+	uint64_t counters[STATS_COUNTERS];
+	struct stats_histogram stages[STATS_STAGES];
+	uint64_t lock_acquired;		//stats_now() when mutex_lock was taken
+	struct stats_thread *next;
+};
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static __thread struct stats_thread	*current		= NULL;
+static struct stats_thread			*threads		= NULL;
+static pthread_mutex_t				threads_lock	= PTHREAD_MUTEX_INITIALIZER;
+static uint64_t						started			= 0;
+
+static const char *stage_names[STATS_STAGES] =
+{
+	"accept", "recv", "lock_wait", "lock_hold", "append", "reply",
+};
+
+static const char *counter_names[STATS_COUNTERS] =
+{
+	"connections_opened", "connections_closed", "packets", "bytes_in", "bytes_out",
+	"batches", "connections_rejected", "packets_rejected", "packets_split",
+	"budget_exceeded", "queue_full",
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	statistics of the calling thread, registering it
+ *					if needed
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	the thread's statistics, NULL if out of memory
+ */
+static struct stats_thread* stats_current(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	maps a latency to its histogram bucket
+ *
+ * @parameters	:	value	:	latency in nanoseconds
+ *
+ * @returns		:	bucket index
+ */
+static unsigned int stats_bucket(uint64_t value);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	largest latency that falls into a bucket
+ *
+ * @parameters	:	bucket	:	bucket index
+ *
+ * @returns		:	latency in nanoseconds
+ */
+static uint64_t stats_bucket_limit(unsigned int bucket);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	latency below which a fraction of the samples fall
+ *
+ * @parameters	:	histogram	:	merged histogram
+ *					fraction	:	0.5 for p50, 0.999 for p999
+ *
+ * @returns		:	latency in nanoseconds, 0 without samples
+ */
+static uint64_t stats_percentile(const struct stats_histogram *histogram, double fraction);
+
+/*------------------------------------------------------------------------*/
+void stats_thread_register(const char *name)
+{
+	struct stats_thread *stats;
+
+	if(current != NULL)
+	{
+		snprintf(current->name, STATS_NAME_SIZE, "%s", name);
+		return;
+	}
+
+	stats = (struct stats_thread *) calloc(1, sizeof(struct stats_thread));
+	if(stats == NULL)
+	{
+		syslog(LOG_ERR,"calloc() failed\n");
+		#if DEBUG
+			printf("calloc() failed\n");
+		#endif
+		return;
+	}
+	snprintf(stats->name, STATS_NAME_SIZE, "%s", name);
+
+	//the statistics outlive the thread, they are part of the totals
+	pthread_mutex_lock(&threads_lock);
+	if(started == 0)
+	{
+		started = stats_now();
+	}
+	stats->next = threads;
+	threads = stats;
+	pthread_mutex_unlock(&threads_lock);
+
+	current = stats;
+}
+/*------------------------------------------------------------------------*/
+uint64_t stats_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec * 1000000000ULL) + now.tv_nsec;
+}
+/*------------------------------------------------------------------------*/
+void stats_record(enum stats_stage stage, uint64_t start)
+{
+	struct stats_thread *stats = stats_current();
+	struct stats_histogram *histogram;
+	uint64_t elapsed;
+
+	if(stats == NULL)
+	{
+		return;
+	}
+	histogram = &stats->stages[stage];
+	elapsed = stats_now() - start;
+
+	STATS_ADD(histogram->buckets[stats_bucket(elapsed)], 1);
+	STATS_ADD(histogram->count, 1);
+	STATS_ADD(histogram->total, elapsed);
+	if(elapsed > histogram->max)
+	{
+		__atomic_store_n(&histogram->max, elapsed, __ATOMIC_RELAXED);
+	}
+}
+/*------------------------------------------------------------------------*/
+void stats_count(enum stats_counter counter, uint64_t amount)
+{
+	struct stats_thread *stats = stats_current();
+
+	if(stats != NULL)
+	{
+		STATS_ADD(stats->counters[counter], amount);
+	}
+}
+/*------------------------------------------------------------------------*/
+int stats_mutex_lock(pthread_mutex_t *lock)
+{
+	struct stats_thread *stats = stats_current();
+	uint64_t start = stats_now();
+	int status;
+
+	status = pthread_mutex_lock(lock);
+	if((status == SUCCESS) && (stats != NULL))
+	{
+		stats_record(STATS_LOCK_WAIT, start);
+		stats->lock_acquired = stats_now();
+	}
+	return status;
+}
+/*------------------------------------------------------------------------*/
+void stats_mutex_unlock(pthread_mutex_t *lock)
+{
+	struct stats_thread *stats = stats_current();
+	uint64_t acquired = (stats != NULL) ? stats->lock_acquired : 0;
+
+	pthread_mutex_unlock(lock);
+	if(stats != NULL)
+	{
+		stats_record(STATS_LOCK_HOLD, acquired);
+	}
+}
+/*------------------------------------------------------------------------*/
+void stats_format(FILE *out, bool json)
+{
+	struct stats_histogram *merged;
+	struct stats_histogram *histogram;
+	struct stats_thread *stats;
+	uint64_t counters[STATS_COUNTERS];
+	uint64_t value, uptime, overflows, drops;
+	size_t queued;
+	int i, j;
+
+	merged = (struct stats_histogram *) calloc(STATS_STAGES, sizeof(struct stats_histogram));
+	if(merged == NULL)
+	{
+		syslog(LOG_ERR,"calloc() failed\n");
+		#if DEBUG
+			printf("calloc() failed\n");
+		#endif
+		return;
+	}
+	memset(counters, 0, sizeof(counters));
+	/*------------------------------------------------------------------------*/
+	pthread_mutex_lock(&threads_lock);
+	uptime = (started != 0) ? ((stats_now() - started) / 1000000000ULL) : 0;
+	for(stats = threads; stats != NULL; stats = stats->next)
+	{
+		for(i = 0; i < STATS_COUNTERS; i++)
+		{
+			counters[i] += STATS_READ(stats->counters[i]);
+		}
+		for(i = 0; i < STATS_STAGES; i++)
+		{
+			histogram = &stats->stages[i];
+			for(j = 0; j < STATS_BUCKETS; j++)
+			{
+				merged[i].buckets[j] += STATS_READ(histogram->buckets[j]);
+			}
+			merged[i].count += STATS_READ(histogram->count);
+			merged[i].total += STATS_READ(histogram->total);
+			value = STATS_READ(histogram->max);
+			if(value > merged[i].max)
+			{
+				merged[i].max = value;
+			}
+		}
+	}
+	/*------------------------------------------------------------------------*/
+	acceptor_listen_stats(&queued, &overflows, &drops);
+	fprintf(out, json ? "{\"uptime_seconds\":%llu,\"connections_active\":%lld,"
+						"\"memory_in_flight\":%zu,\"listen_queued\":%zu,"
+						"\"listen_overflows\":%llu,\"listen_drops\":%llu,"
+						"\"log_dropped\":%llu,\"counters\":{"
+					  : "uptime_seconds %llu\nconnections_active %lld\nmemory_in_flight %zu\n"
+						"listen_queued %zu\nlisten_overflows %llu\nlisten_drops %llu\n"
+						"log_dropped %llu\n",
+			(unsigned long long) uptime,
+			(long long) (counters[STATS_CONNECTIONS_OPENED] - counters[STATS_CONNECTIONS_CLOSED]),
+			admission_memory_used(), queued,
+			(unsigned long long) overflows, (unsigned long long) drops,
+			(unsigned long long) async_log_dropped());
+	for(i = 0; i < STATS_COUNTERS; i++)
+	{
+		fprintf(out, json ? "%s\"%s\":%llu" : "%s%s %llu\n", (json && i) ? "," : "",
+				counter_names[i], (unsigned long long) counters[i]);
+	}
+	/*------------------------------------------------------------------------*/
+	fprintf(out, json ? "},\"stages\":{" : "stage count mean_ns p50_ns p99_ns p999_ns max_ns\n");
+	for(i = 0; i < STATS_STAGES; i++)
+	{
+		fprintf(out, json ? "%s\"%s\":{\"count\":%llu,\"mean_ns\":%llu,\"p50_ns\":%llu,"
+							"\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu}"
+						  : "%s%s %llu %llu %llu %llu %llu %llu\n",
+				(json && i) ? "," : "", stage_names[i],
+				(unsigned long long) merged[i].count,
+				(unsigned long long) (merged[i].count ? (merged[i].total / merged[i].count) : 0),
+				(unsigned long long) stats_percentile(&merged[i], 0.5),
+				(unsigned long long) stats_percentile(&merged[i], 0.99),
+				(unsigned long long) stats_percentile(&merged[i], 0.999),
+				(unsigned long long) merged[i].max);
+	}
+	/*------------------------------------------------------------------------*/
+	fprintf(out, json ? "},\"threads\":[" : "");
+	for(stats = threads; stats != NULL; stats = stats->next)
+	{
+		fprintf(out, json ? "%s{\"name\":\"%s\"" : "%sthread %s", (json && (stats != threads)) ? "," : "",
+				stats->name);
+		for(i = 0; i < STATS_COUNTERS; i++)
+		{
+			fprintf(out, json ? ",\"%s\":%llu" : " %s %llu", counter_names[i],
+					(unsigned long long) STATS_READ(stats->counters[i]));
+		}
+		fprintf(out, json ? "}" : "\n");
+	}
+	fprintf(out, json ? "]}\n" : "");
+	pthread_mutex_unlock(&threads_lock);
+
+	free(merged);
+}
+/*------------------------------------------------------------------------*/
+static struct stats_thread* stats_current(void)
+{
+	if(current == NULL)
+	{
+		stats_thread_register("thread");
+	}
+	return current;
+}
+/*------------------------------------------------------------------------*/
+static unsigned int stats_bucket(uint64_t value)
+{
+	unsigned int shift;
+
+	if(value < STATS_SUB_BUCKETS)
+	{
+		return (unsigned int) value;
+	}
+	//keep the top STATS_SUB_BITS + 1 bits, the highest is always set
+	shift = (63 - __builtin_clzll(value)) - STATS_SUB_BITS;
+	return (shift * STATS_SUB_BUCKETS) + (unsigned int) (value >> shift);
+}
+/*------------------------------------------------------------------------*/
+static uint64_t stats_bucket_limit(unsigned int bucket)
+{
+	unsigned int shift;
+	uint64_t mantissa;
+
+	if(bucket < (2 * STATS_SUB_BUCKETS))
+	{
+		return bucket;
+	}
+	shift 		= (bucket / STATS_SUB_BUCKETS) - 1;
+	mantissa 	= bucket - (shift * STATS_SUB_BUCKETS);
+	return ((mantissa + 1) << shift) - 1;
+}
+/*------------------------------------------------------------------------*/
+static uint64_t stats_percentile(const struct stats_histogram *histogram, double fraction)
+{
+	uint64_t wanted, seen = 0;
+	unsigned int i;
+
+	if(histogram->count == 0)
+	{
+		return 0;
+	}
+	//rank of the sample, rounded up
+	wanted = (uint64_t) (fraction * histogram->count);
+	if((wanted == 0) || (wanted < (fraction * histogram->count)))
+	{
+		wanted++;
+	}
+
+	for(i = 0; i < STATS_BUCKETS; i++)
+	{
+		seen += histogram->buckets[i];
+		if(seen >= wanted)
+		{
+			//never report more than the largest sample
+			return (stats_bucket_limit(i) < histogram->max) ? stats_bucket_limit(i) : histogram->max;
+		}
+	}
+	return histogram->max;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
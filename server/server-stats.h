@@ -0,0 +1,131 @@
+/*
+ * @filename 		:	server-stats.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Low overhead runtime statistics for aesdsocket.
+ *						Every thread owns its counters and log-linear
+ *						(HDR style) latency histograms, so recording is
+ *						a couple of plain stores and never takes a lock.
+ *						stats_format() merges all threads on demand,
+ *						it is served through the admin socket.
+ *
+ *						Histograms keep 16 sub-buckets per power of two
+ *						of nanoseconds, percentiles are reported as the
+ *						upper bound of their bucket (< 6.25% error).
+ */
+#ifndef SERVER_STATS_H_
+#define SERVER_STATS_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+
+/*------------------------------------------------------------------------*/
+/*							STAGES AND COUNTERS							  */
+/*------------------------------------------------------------------------*/
+enum stats_stage
+{
+	STATS_ACCEPT,		//accept() returned until the pool owns the socket
+	STATS_RECV,			//one recv() that returned data
+	STATS_LOCK_WAIT,	//waiting for mutex_lock
+	STATS_LOCK_HOLD,	//mutex_lock held
+	STATS_APPEND,		//one group commit of the storage writer
+	STATS_REPLY,		//reply streaming started until fully sent
+	STATS_STAGES
+};
+
+enum stats_counter
+{
+	STATS_CONNECTIONS_OPENED,
+	STATS_CONNECTIONS_CLOSED,
+	STATS_PACKETS,
+	STATS_BYTES_IN,
+	STATS_BYTES_OUT,
+	STATS_BATCHES,		//group commits of the storage writer
+	STATS_CONNECTIONS_REJECTED,	//over the connection limit
+	STATS_PACKETS_REJECTED,	//over the packet limit, connection closed
+	STATS_PACKETS_SPLIT,	//fragments stored of packets over the limit
+	STATS_BUDGET_EXCEEDED,	//connections closed over the memory budget
+	STATS_QUEUE_FULL,		//acceptor waited on a full connection queue
+	STATS_COUNTERS
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	gives the calling thread its own statistics. Threads
+ *					that record without registering are registered on
+ *					first use under a generic name.
+ *
+ * @parameters	:	name	:	thread name shown in the statistics
+ *
+ * @returns		:	none
+ */
+void stats_thread_register(const char *name);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	monotonic clock used for every stage
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	current time in nanoseconds
+ */
+uint64_t stats_now(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	records the time elapsed since start for a stage
+ *
+ * @parameters	:	stage	:	stage that finished
+ *					start	:	stats_now() when the stage began
+ *
+ * @returns		:	none
+ */
+void stats_record(enum stats_stage stage, uint64_t start);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	adds to one of the calling thread's counters
+ *
+ * @parameters	:	counter	:	counter to increase
+ *					amount	:	value to add
+ *
+ * @returns		:	none
+ */
+void stats_count(enum stats_counter counter, uint64_t amount);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	locks mutex_lock, recording the wait time
+ *
+ * @parameters	:	lock	:	mutex to lock
+ *
+ * @returns		:	result of pthread_mutex_lock()
+ */
+int stats_mutex_lock(pthread_mutex_t *lock);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	unlocks a mutex locked with stats_mutex_lock(),
+ *					recording the hold time
+ *
+ * @parameters	:	lock	:	mutex to unlock
+ *
+ * @returns		:	none
+ */
+void stats_mutex_unlock(pthread_mutex_t *lock);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	writes the merged statistics of every thread
+ *
+ * @parameters	:	out		:	stream to write to
+ *					json	:	JSON instead of plain text
+ *
+ * @returns		:	none
+ */
+void stats_format(FILE *out, bool json);
+
+#endif /* SERVER_STATS_H_ */
+/*EOF*/
@@ -0,0 +1,827 @@
+/*
+ * @filename 		:	storage-backend.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						File, aesdchar and memory storage backends.
+ *						The file backend and its segment retention.
+ *						Handing the history to a successor process.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "aesdsocket.h"
+#include "storage-backend.h"
+#include "history-cache.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+/*							SEGMENT STRUCTURE							  */
+/*------------------------------------------------------------------------*/
+//bookkeeping of one segment file, owned by the file backend
+struct file_segment
+{
+	struct reply_file *file;		//holds the reference of the storage
+	unsigned long sequence;			//renamed to <path>.<sequence>, 0 while newest
+	size_t bytes;
+	size_t packets;
+	time_t created;
+	time_t written;					//newest packet, only kept with -T
+	struct file_segment *next;
+};
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static const struct storage_backend	*active			= NULL;
+static const char 					*storage_path	= NULL;
+static int 							storage_fd		= ERROR;	//kept open for appends
+static size_t						stored_bytes	= 0;
+static bool							replies_cached	= false;	//replies served from memory
+static bool							mirror_cache	= false;	//backend appends go to the cache too
+
+static struct storage_retention		retention;
+static struct file_segment			*oldest			= NULL;
+static struct file_segment			*newest			= NULL;		//appended to, at storage_path
+static unsigned long				next_sequence	= 1;
+static size_t						retained_bytes	= 0;
+static size_t						retained_packets = 0;
+static size_t						retained_from	= 0;		//oldest history offset still stored
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	creates a new newest segment at storage_path, after
+ *					the current newest one was renamed
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int file_segment_open(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	reopens the segments a predecessor process described,
+ *					oldest first, and loads them into the history cache
+ *					with -c
+ *
+ * @parameters	:	adopted	:	SEGMENT lines of storage_describe()
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int file_segments_adopt(const char *adopted);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	links an opened segment file behind the newest one
+ *
+ * @parameters	:	fd			:	segment file, owned from now on
+ *					sequence	:	0 for the file at storage_path, else
+ *									the n of <path>.<n>
+ *
+ * @returns		:	the segment, NULL on failure (fd is closed)
+ */
+static struct file_segment* file_segment_add(int fd, unsigned long sequence);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	copies a segment file into the history cache, one
+ *					cache segment per line so every packet boundary is
+ *					a cache boundary
+ *
+ * @parameters	:	segment	:	segment to read
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int file_segment_cache(struct file_segment *segment);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	whether the newest segment reached its share of a
+ *					retention limit and the next batch starts a new one
+ *
+ * @parameters	:	now		:	current monotonic time in seconds
+ *
+ * @returns		:	true if the segment has to be rotated
+ */
+static bool file_segment_full(time_t now);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	renames the newest segment to <path>.<n> and opens
+ *					a new one in its place
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int file_rotate(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	deletes the oldest segments while the history is
+ *					over a retention limit. The newest one is kept.
+ *
+ * @parameters	:	now		:	current monotonic time in seconds
+ *
+ * @returns		:	none
+ */
+static void file_expire(time_t now);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	unlinks a segment file where requested and drops the
+ *					storage reference. Replies still streaming it keep
+ *					the descriptor open.
+ *
+ * @parameters	:	segment	:	segment already taken off the list
+ *					remove	:	unlink the file
+ *
+ * @returns		:	none
+ */
+static void file_segment_free(struct file_segment *segment, bool remove);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	current time for the age limit
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	monotonic seconds, 0 without an age limit
+ */
+static time_t file_now(void);
+
+/*------------------------------------------------------------------------*/
+/* 						FILE AND CHARDEV BACKENDS	 					  */
+/*------------------------------------------------------------------------*/
+static int file_open(const char *path, const char *adopted)
+{
+	oldest 				= NULL;
+	newest 				= NULL;
+	retained_bytes 		= 0;
+	retained_packets 	= 0;
+	if(adopted != NULL)
+	{
+		return file_segments_adopt(adopted);
+	}
+	return file_segment_open();
+}
+/*------------------------------------------------------------------------*/
+static int chardev_open(const char *path, const char *adopted)
+{
+	//offsets continue, but the driver only keeps its latest entries so
+	//the cache cannot be rebuilt from it and starts empty
+	if((adopted != NULL) && mirror_cache)
+	{
+		history_cache_start(stored_bytes);
+	}
+
+
+	//the driver owns its history, it is neither created nor truncated
+	storage_fd = open(path, O_WRONLY | O_CLOEXEC);
+	if(storage_fd == ERROR)
+	{
+		syslog(LOG_ERR,"open() failed for %s\n", path);
+		#if DEBUG
+			printf("open() failed for %s\n", path);
+		#endif
+		return ERROR;
+	}
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static int fd_append(struct iovec *iov, int count)
+{
+	ssize_t status;
+
+	//one writev() per batch. aesdchar splits what it is given at the
+	//newlines, so every packet stays one entry.
+	while(count > 0)
+	{
+		status = writev(storage_fd, iov, count);
+		if(status == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			async_log(LOG_ERR,"writev() failed\n");
+			#if DEBUG
+				printf("writev() failed\n");
+			#endif
+			return ERROR;
+		}
+		stored_bytes += status;
+
+		//skip what was written, a short write resumes inside a packet
+		while((count > 0) && ((size_t) status >= iov->iov_len))
+		{
+			status -= iov->iov_len;
+			iov++;
+			count--;
+		}
+		if(count > 0)
+		{
+			iov->iov_base 	= (char *) iov->iov_base + status;
+			iov->iov_len 	-= status;
+		}
+	}
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static size_t fd_size(void)
+{
+	return stored_bytes;
+}
+/*------------------------------------------------------------------------*/
+static int file_append(struct iovec *iov, int count)
+{
+	time_t now = file_now();
+	size_t before = stored_bytes;
+	int status;
+
+	//rotate on batch boundaries only, a snapshot never ends inside a
+	//segment that is not yet complete on disk. A failed rotation keeps
+	//the batch in the current segment, the next batch retries it.
+	if(file_segment_full(now) && (file_rotate() == ERROR))
+	{
+		async_log(LOG_WARNING,"Could not rotate %s, appending to it\n", storage_path);
+		#if DEBUG
+			printf("Could not rotate %s, appending to it\n", storage_path);
+		#endif
+	}
+
+	//bytes follow whatever reached the file, packets count only once
+	//the whole batch is stored
+	status = fd_append(iov, count);
+	newest->bytes 		+= stored_bytes - before;
+	newest->written 	= now;
+	retained_bytes 		+= stored_bytes - before;
+	if(status == SUCCESS)
+	{
+		newest->packets 	+= count;
+		retained_packets 	+= count;
+	}
+
+	file_expire(now);
+	if(mirror_cache)
+	{
+		history_cache_trim(retained_from);
+	}
+	return status;
+}
+/*------------------------------------------------------------------------*/
+static void file_snapshot(struct reply *reply)
+{
+	struct file_segment *segment = oldest;
+
+	if(reply->offset == reply->end)
+	{
+		return;
+	}
+	while((segment->next != NULL) && ((off_t) segment->next->file->start <= reply->offset))
+	{
+		segment = segment->next;
+	}
+	reply_open_file(reply, segment->file);
+}
+/*------------------------------------------------------------------------*/
+static int file_stream(struct reply *reply)
+{
+	//the segments were pinned by the snapshot
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static int chardev_stream(struct reply *reply)
+{
+	return reply_open_stream(reply, storage_path);
+}
+/*------------------------------------------------------------------------*/
+static void file_close(bool remove)
+{
+	struct file_segment *segment;
+
+	while((segment = oldest) != NULL)
+	{
+		oldest = segment->next;
+		file_segment_free(segment, remove);
+	}
+	newest 		= NULL;
+	storage_fd 	= ERROR;
+}
+/*------------------------------------------------------------------------*/
+static void chardev_close(bool remove)
+{
+	//never unlink the device node
+	close(storage_fd);
+	storage_fd = ERROR;
+}
+
+/*------------------------------------------------------------------------*/
+/* 							MEMORY BACKEND			 					  */
+/*------------------------------------------------------------------------*/
+static int memory_open(const char *path, const char *adopted)
+{
+	//the history lived in the memory of the predecessor and is gone
+	stored_bytes 	= 0;
+	retained_from 	= 0;
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static int memory_append(struct iovec *iov, int count)
+{
+	int i;
+
+	for(i = 0; i < count; i++)
+	{
+		if(history_cache_append(iov[i].iov_base, iov[i].iov_len) == ERROR)
+		{
+			return ERROR;
+		}
+	}
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static size_t memory_size(void)
+{
+	return history_cache_size();
+}
+/*------------------------------------------------------------------------*/
+static int memory_stream(struct reply *reply)
+{
+	//the cursor captured by storage_snapshot() is all that is needed
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static void memory_close(bool remove)
+{
+}
+
+/*------------------------------------------------------------------------*/
+/*							BACKEND TABLE								  */
+/*------------------------------------------------------------------------*/
+static const struct storage_backend backends[] =
+{
+	{
+		.name 			= "file",
+		.default_path 	= AESD_DATA_FILE_PATH,
+		.timestamps 	= true,
+		.open 			= file_open,
+		.append 		= file_append,
+		.size 			= fd_size,
+		.snapshot 		= file_snapshot,
+		.stream 		= file_stream,
+		.close 			= file_close,
+	},
+	{
+		.name 			= "chardev",
+		.default_path 	= AESD_CHAR_DEVICE_PATH,
+		.timestamps 	= false,
+		.open 			= chardev_open,
+		.append 		= fd_append,
+		.size 			= fd_size,
+		.snapshot 		= NULL,
+		.stream 		= chardev_stream,
+		.close 			= chardev_close,
+	},
+	{
+		.name 			= "memory",
+		.default_path 	= NULL,
+		.timestamps 	= true,
+		.open 			= memory_open,
+		.append 		= memory_append,
+		.size 			= memory_size,
+		.snapshot 		= NULL,
+		.stream 		= memory_stream,
+		.close 			= memory_close,
+	},
+};
+
+/*------------------------------------------------------------------------*/
+const struct storage_backend* storage_find(const char *name)
+{
+	size_t i;
+
+	for(i = 0; i < (sizeof(backends) / sizeof(backends[0])); i++)
+	{
+		if(!strcmp(backends[i].name, name))
+		{
+			return &backends[i];
+		}
+	}
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+int storage_open(const struct storage_backend *backend, const char *path, bool cache,
+					const struct storage_retention *retention_policy, const char *adopted)
+{
+	active 			= backend;
+	storage_path 	= (path != NULL) ? path : backend->default_path;
+	stored_bytes 	= 0;
+	retained_from 	= 0;
+	next_sequence 	= 1;
+	replies_cached 	= cache || (backend->append == memory_append);
+	mirror_cache 	= cache && (backend->append != memory_append);
+	retention 		= *retention_policy;
+
+	if((adopted != NULL) &&
+		(sscanf(adopted, "HISTORY %zu %zu %lu", &stored_bytes, &retained_from, &next_sequence) != 3))
+	{
+		syslog(LOG_WARNING,"Ignoring malformed history of the predecessor\n");
+		adopted = NULL;
+	}
+
+	if((backend->append != file_append) &&
+		(retention.max_bytes || retention.max_packets || retention.max_age))
+	{
+		syslog(LOG_WARNING,"Retention limits only apply to the file backend\n");
+	}
+
+	if(backend->open(storage_path, adopted) == ERROR)
+	{
+		if(adopted == NULL)
+		{
+			return ERROR;
+		}
+
+		//a history that cannot be continued is dropped, not served wrong
+		syslog(LOG_WARNING,"Could not continue the history, starting empty\n");
+		history_cache_destroy();
+		stored_bytes 	= 0;
+		retained_from 	= 0;
+		next_sequence 	= 1;
+		adopted 		= NULL;
+		if(backend->open(storage_path, NULL) == ERROR)
+		{
+			return ERROR;
+		}
+	}
+
+	syslog(LOG_INFO,"Using %s storage%s%s%s%s\n", backend->name,
+			(storage_path != NULL) ? " at " : "", (storage_path != NULL) ? storage_path : "",
+			mirror_cache ? " with history cache" : "",
+			(adopted != NULL) ? ", history continued" : "");
+	#if DEBUG
+		printf("Using %s storage\n", backend->name);
+	#endif
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int storage_append(struct iovec *iov, int count)
+{
+	int i;
+
+	//the cache goes first, the backend may consume iov
+	for(i = 0; mirror_cache && (i < count); i++)
+	{
+		if(history_cache_append(iov[i].iov_base, iov[i].iov_len) == ERROR)
+		{
+			return ERROR;
+		}
+	}
+	return active->append(iov, count);
+}
+/*------------------------------------------------------------------------*/
+void storage_snapshot(struct reply *reply, size_t since, size_t end)
+{
+	//history dropped by retention is gone for the cache too, so the
+	//reply does not depend on -c
+	if(since < retained_from)
+	{
+		since = retained_from;
+	}
+	reply->end 		= (off_t) end;
+	reply->offset 	= (off_t) ((since < end) ? since : end);
+	if(replies_cached)
+	{
+		history_cache_snapshot(&reply->cursor, since, end);
+	}
+	else if(active->snapshot != NULL)
+	{
+		active->snapshot(reply);
+	}
+}
+/*------------------------------------------------------------------------*/
+size_t storage_size(void)
+{
+	return active->size();
+}
+/*------------------------------------------------------------------------*/
+int storage_stream(struct reply *reply)
+{
+	if(replies_cached)
+	{
+		return SUCCESS;
+	}
+	return active->stream(reply);
+}
+/*------------------------------------------------------------------------*/
+bool storage_wants_timestamps(void)
+{
+	return active->timestamps;
+}
+/*------------------------------------------------------------------------*/
+char* storage_describe(void)
+{
+	struct file_segment *segment;
+	char *text = NULL;
+	size_t length;
+	FILE *stream;
+
+	stream = open_memstream(&text, &length);
+	if(stream == NULL)
+	{
+		syslog(LOG_ERR,"open_memstream() failed\n");
+		#if DEBUG
+			printf("open_memstream() failed\n");
+		#endif
+		return NULL;
+	}
+
+	fprintf(stream, "HISTORY %zu %zu %lu\n", stored_bytes, retained_from, next_sequence);
+	for(segment = oldest; (active->append == file_append) && (segment != NULL); segment = segment->next)
+	{
+		fprintf(stream, "SEGMENT %lu %zu %zu\n", segment->sequence, segment->bytes, segment->packets);
+	}
+
+	if(fclose(stream) != SUCCESS)
+	{
+		free(text);
+		return NULL;
+	}
+	return text;
+}
+/*------------------------------------------------------------------------*/
+void storage_close(bool remove)
+{
+	if(active == NULL)
+	{
+		return;
+	}
+
+	active->close(remove);
+	history_cache_destroy();
+	active = NULL;
+}
+
+/*------------------------------------------------------------------------*/
+/* 							FILE SEGMENTS			 					  */
+/*------------------------------------------------------------------------*/
+static int file_segments_adopt(const char *adopted)
+{
+	struct file_segment *segment;
+	char name[PATH_MAX];
+	unsigned long sequence;
+	size_t bytes, packets;
+	int fd;
+
+	if(mirror_cache)
+	{
+		history_cache_start(retained_from);
+	}
+
+	stored_bytes = retained_from;
+	for(adopted = strchr(adopted, '\n'); adopted != NULL; adopted = strchr(adopted + 1, '\n'))
+	{
+		if(sscanf(adopted + 1, "SEGMENT %lu %zu %zu", &sequence, &bytes, &packets) != 3)
+		{
+			continue;
+		}
+
+		//rotated segments are only read, the newest one is appended to
+		if(sequence == 0)
+		{
+			fd = open(storage_path, O_RDWR | O_APPEND | O_CLOEXEC);
+		}
+		else
+		{
+			snprintf(name, sizeof(name), "%s.%lu", storage_path, sequence);
+			fd = open(name, O_RDONLY | O_CLOEXEC);
+		}
+		if(fd == ERROR)
+		{
+			syslog(LOG_ERR,"open() failed for segment %lu of %s\n", sequence, storage_path);
+			#if DEBUG
+				printf("open() failed for segment %lu of %s\n", sequence, storage_path);
+			#endif
+			goto cleanup;
+		}
+
+		segment = file_segment_add(fd, sequence);
+		if(segment == NULL)
+		{
+			goto cleanup;
+		}
+		segment->bytes 		= bytes;
+		segment->packets 	= packets;
+		stored_bytes 		+= bytes;
+		retained_bytes 		+= bytes;
+		retained_packets 	+= packets;
+
+		if(mirror_cache && (file_segment_cache(segment) == ERROR))
+		{
+			goto cleanup;
+		}
+	}
+
+	//the newest segment is the one at storage_path
+	if((newest == NULL) || (newest->sequence != 0))
+	{
+		syslog(LOG_ERR,"No newest segment at %s\n", storage_path);
+		goto cleanup;
+	}
+	return SUCCESS;
+
+cleanup:
+	file_close(false);
+	return ERROR;
+}
+/*------------------------------------------------------------------------*/
+static int file_segment_open(void)
+{
+	int fd;
+
+	//readable as well, replies sendfile() from the same descriptor
+	fd = open(storage_path, O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, FILE_PERMISSIONS);
+	if(fd == ERROR)
+	{
+		async_log(LOG_ERR,"open() failed for %s\n", storage_path);
+		#if DEBUG
+			printf("open() failed for %s\n", storage_path);
+		#endif
+		return ERROR;
+	}
+
+	return (file_segment_add(fd, 0) != NULL) ? SUCCESS : ERROR;
+}
+/*------------------------------------------------------------------------*/
+static struct file_segment* file_segment_add(int fd, unsigned long sequence)
+{
+	struct file_segment *segment;
+
+	segment = (struct file_segment *) calloc(1, sizeof(struct file_segment));
+	if(segment == NULL)
+	{
+		async_log(LOG_ERR,"calloc() failed\n");
+		#if DEBUG
+			printf("calloc() failed\n");
+		#endif
+		close(fd);
+		return NULL;
+	}
+	segment->file = reply_file_create(fd, stored_bytes);
+	if(segment->file == NULL)
+	{
+		close(fd);
+		free(segment);
+		return NULL;
+	}
+	segment->sequence = sequence;
+	segment->created = file_now();
+	segment->written = segment->created;
+	/*------------------------------------------------------------------------*/
+	if(newest != NULL)
+	{
+		reply_file_link(newest->file, segment->file);
+		newest->next = segment;
+	}
+	else
+	{
+		oldest = segment;
+	}
+	newest 		= segment;
+	storage_fd 	= fd;
+	return segment;
+}
+/*------------------------------------------------------------------------*/
+static int file_segment_cache(struct file_segment *segment)
+{
+	char buffer[BUFFER_SIZE];
+	size_t done = 0, used, line;
+	ssize_t status;
+	char *newline;
+
+	while(done < segment->bytes)
+	{
+		used = segment->bytes - done;
+		status = pread(segment->file->fd, buffer, (used < sizeof(buffer)) ? used : sizeof(buffer), done);
+		if(status <= 0)
+		{
+			syslog(LOG_ERR,"pread() failed on segment %lu of %s\n", segment->sequence, storage_path);
+			#if DEBUG
+				printf("pread() failed on segment %lu of %s\n", segment->sequence, storage_path);
+			#endif
+			return ERROR;
+		}
+		done += status;
+
+		//a line cut by the buffer becomes two cache segments, harmless
+		//since snapshots only end after a newline
+		for(used = 0; used < (size_t) status; used += line)
+		{
+			newline = memchr(buffer + used, '\n', status - used);
+			line = (newline != NULL) ? (size_t) (newline - buffer) + 1 - used : status - used;
+			if(history_cache_append(buffer + used, line) == ERROR)
+			{
+				return ERROR;
+			}
+		}
+	}
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static bool file_segment_full(time_t now)
+{
+	if(newest->packets == 0)
+	{
+		return false;
+	}
+
+	return ((retention.max_bytes > 0) &&
+				(newest->bytes * STORAGE_SEGMENTS >= retention.max_bytes)) ||
+			((retention.max_packets > 0) &&
+				(newest->packets * STORAGE_SEGMENTS >= retention.max_packets)) ||
+			((retention.max_age > 0) &&
+				((now - newest->created) * STORAGE_SEGMENTS >= retention.max_age));
+}
+/*------------------------------------------------------------------------*/
+static int file_rotate(void)
+{
+	char rotated[PATH_MAX];
+
+	snprintf(rotated, sizeof(rotated), "%s.%lu", storage_path, next_sequence);
+	if(rename(storage_path, rotated) == ERROR)
+	{
+		async_log(LOG_ERR,"rename() failed for %s\n", rotated);
+		#if DEBUG
+			printf("rename() failed for %s\n", rotated);
+		#endif
+		return ERROR;
+	}
+	newest->sequence = next_sequence;
+
+	if(file_segment_open() == ERROR)
+	{
+		//keep appending to the renamed segment, rotation is retried
+		rename(rotated, storage_path);
+		newest->sequence = 0;
+		return ERROR;
+	}
+	next_sequence++;
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static void file_expire(time_t now)
+{
+	struct file_segment *segment;
+
+	while((oldest != newest) &&
+			(((retention.max_bytes > 0) && (retained_bytes > retention.max_bytes)) ||
+			((retention.max_packets > 0) && (retained_packets > retention.max_packets)) ||
+			((retention.max_age > 0) && (now - oldest->written >= retention.max_age))))
+	{
+		segment 			= oldest;
+		oldest 				= segment->next;
+		retained_bytes 		-= segment->bytes;
+		retained_packets 	-= segment->packets;
+		retained_from 		= oldest->file->start;
+		file_segment_free(segment, true);
+	}
+}
+/*------------------------------------------------------------------------*/
+static void file_segment_free(struct file_segment *segment, bool remove)
+{
+	char rotated[PATH_MAX];
+
+	if(remove && (segment->sequence == 0))
+	{
+		unlink(storage_path);
+	}
+	else if(remove)
+	{
+		snprintf(rotated, sizeof(rotated), "%s.%lu", storage_path, segment->sequence);
+		unlink(rotated);
+	}
+	reply_file_put(segment->file);
+	free(segment);
+}
+/*------------------------------------------------------------------------*/
+static time_t file_now(void)
+{
+	struct timespec now;
+
+	if(retention.max_age == 0)
+	{
+		return 0;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
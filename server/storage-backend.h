@@ -0,0 +1,216 @@
+/*
+ * @filename 		:	storage-backend.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Runtime selectable storage for the packet history.
+ *						Every backend implements the same small set of
+ *						operations, the one to use is picked with -b:
+ *
+ *							file	:	regular file, replies via sendfile()
+ *							chardev	:	the aesdchar driver
+ *							memory	:	history cache only, nothing on disk
+ *
+ *						With -c the history cache is layered on top of
+ *						the file or chardev backend and replies are served
+ *						from memory while the backend is kept as a mirror.
+ *
+ *						The file backend keeps the history in segment
+ *						files: the newest one at the storage path, older
+ *						ones renamed to <path>.<n>. With a retention
+ *						limit (-R, -N, -T) a segment is rotated once it
+ *						holds 1/STORAGE_SEGMENTS of the limit and whole
+ *						segments are deleted, oldest first, while the
+ *						history is over it. History offsets keep counting
+ *						from the start, replies and AESD_SINCE requests
+ *						below the oldest retained byte start there. The
+ *						history cache (-c) frees its blocks below the
+ *						oldest retained byte as well.
+ *
+ *						On a handoff (-H) the history is passed on as a
+ *						short text from storage_describe(): the successor
+ *						reopens the same segment files, or the same
+ *						device, and offsets continue where they were.
+ *						Segment ages restart with the successor. The
+ *						history of the memory backend is not carried over.
+ */
+#ifndef STORAGE_BACKEND_H_
+#define STORAGE_BACKEND_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/uio.h>
+
+#include "reply-engine.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+//segments retained per limit, deleting one drops 1/STORAGE_SEGMENTS of it
+#define STORAGE_SEGMENTS	(8)
+
+/*------------------------------------------------------------------------*/
+/*							RETENTION POLICY							  */
+/*------------------------------------------------------------------------*/
+//0 disables a limit, with all of them 0 the history is kept forever
+struct storage_retention
+{
+	size_t max_bytes;		//bytes of history
+	size_t max_packets;		//packets of history
+	time_t max_age;			//seconds since the newest packet of a segment
+};
+
+/*------------------------------------------------------------------------*/
+/*							BACKEND INTERFACE							  */
+/*------------------------------------------------------------------------*/
+struct storage_backend
+{
+	const char *name;			//value of -b selecting this backend
+	const char *default_path;	//used when -s is not given, may be NULL
+	bool timestamps;			//periodic timestamps are appended
+	/*
+	 * prepares path for appending, truncating any previous history
+	 * unless adopted describes one to continue
+	 */
+	int (*open)(const char *path, const char *adopted);
+	/*
+	 * appends count packets in order, called with mutex_lock held.
+	 * iov may be modified.
+	 */
+	int (*append)(struct iovec *iov, int count);
+	/*
+	 * bytes appended so far, called with mutex_lock held
+	 */
+	size_t (*size)(void);
+	/*
+	 * pins what the snapshot in reply streams from, called with
+	 * mutex_lock held, may be NULL
+	 */
+	void (*snapshot)(struct reply *reply);
+	/*
+	 * prepares reply to stream the history to a client fd, called
+	 * without mutex_lock after reply->end has been captured
+	 */
+	int (*stream)(struct reply *reply);
+	/*
+	 * releases the backend, remove discards the stored history
+	 */
+	void (*close)(bool remove);
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	looks up a backend by name
+ *
+ * @parameters	:	name	:	backend name given with -b
+ *
+ * @returns		:	the backend, NULL if there is none by that name
+ */
+const struct storage_backend* storage_find(const char *name);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	opens the selected backend
+ *
+ * @parameters	:	backend		:	backend returned by storage_find()
+ *					path		:	storage path, NULL for the backend default
+ *					cache		:	layer the history cache on top
+ *					retention	:	limits of the file backend
+ *					adopted		:	storage_describe() of a predecessor
+ *									process, NULL to start empty. A
+ *									history that cannot be continued
+ *									is dropped with a warning.
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int storage_open(const struct storage_backend *backend, const char *path, bool cache,
+					const struct storage_retention *retention, const char *adopted);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	appends a batch of packets to the backend and the
+ *					cache. The caller must hold mutex_lock.
+ *
+ * @parameters	:	iov		:	one entry per packet, may be modified
+ *					count	:	number of entries
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int storage_append(struct iovec *iov, int count);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	captures the history up to byte end into reply. The
+ *					caller must hold mutex_lock.
+ *
+ *					The reply starts at byte since, or at the oldest
+ *					retained byte if that is later. The chardev backend
+ *					only holds its latest entries and always replies
+ *					with all of them.
+ *
+ * @parameters	:	reply	:	reply to fill
+ *					since	:	first byte to send, 0 for the full history
+ *					end		:	end of the snapshot, a packet boundary not
+ *								above storage_size()
+ *
+ * @returns		:	none
+ */
+void storage_snapshot(struct reply *reply, size_t since, size_t end);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	bytes appended so far. The caller must hold
+ *					mutex_lock.
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	size of the history in bytes, including bytes
+ *					already dropped by retention
+ */
+size_t storage_size(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	prepares the snapshot in reply for reply_send().
+ *					Must be called without mutex_lock.
+ *
+ * @parameters	:	reply	:	reply filled by storage_snapshot()
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int storage_stream(struct reply *reply);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	whether periodic timestamps go to this backend
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	true if timestamps are appended
+ */
+bool storage_wants_timestamps(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	describes the history for a successor process, for
+ *					storage_open() there. Nothing may be appended after
+ *					it, the storage writer must be stopped.
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	text allocated with malloc(), NULL on failure
+ */
+char* storage_describe(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	closes the backend and frees the cache
+ *
+ * @parameters	:	remove	:	also remove the history where the backend
+ *								owns it, false when a successor took it
+ *								over
+ *
+ * @returns		:	none
+ */
+void storage_close(bool remove);
+
+#endif /* STORAGE_BACKEND_H_ */
+/*EOF*/
@@ -0,0 +1,276 @@
+/*
+ * @filename 		:	storage-writer.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Group committing storage writer thread.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <syslog.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+
+#include "aesdsocket.h"
+#include "storage-backend.h"
+#include "storage-writer.h"
+#include "server-stats.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static struct mpsc_queue	requests;
+static pthread_t			writer_thread;
+static bool					writer_running	= false;
+static bool					writer_stopping	= false;
+static bool					writer_idle		= false;	//writer waits on wake_fd
+static int					wake_fd			= ERROR;
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	commits batches until stopped, sleeping on wake_fd
+ *					while the queue is empty
+ *
+ * @parameters	:	arg	:	unused
+ *
+ * @returns		:	NULL
+ */
+static void* storage_writer_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	appends up to STORAGE_BATCH_MAX queued requests with
+ *					one storage_append(), takes their snapshots and
+ *					hands them back
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	number of requests committed
+ */
+static int storage_writer_commit(void);
+
+/*------------------------------------------------------------------------*/
+struct storage_request* storage_request_alloc(const char *data, size_t length)
+{
+	struct storage_request *request;
+
+	request = (struct storage_request *) malloc(sizeof(struct storage_request) + length);
+	if(request == NULL)
+	{
+		async_log(LOG_ERR,"malloc() failed\n");
+		#if DEBUG
+			printf("malloc() failed\n");
+		#endif
+		return NULL;
+	}
+	memset(request, 0, sizeof(struct storage_request));
+	request->done_fd 	= ERROR;
+	request->length 	= length;
+	if(length > 0)
+	{
+		memcpy(request->data, data, length);
+	}
+	return request;
+}
+/*------------------------------------------------------------------------*/
+void storage_writer_submit(struct storage_request *request)
+{
+	mpsc_queue_push(&requests, &request->node);
+
+	//only a sleeping writer costs a syscall
+	if(__atomic_exchange_n(&writer_idle, false, __ATOMIC_SEQ_CST))
+	{
+		eventfd_write(wake_fd, 1);
+	}
+}
+/*------------------------------------------------------------------------*/
+int storage_writer_start(void)
+{
+	sigset_t blocked, previous;
+	int status;
+
+	mpsc_queue_init(&requests);
+	writer_stopping = false;
+	writer_idle = false;
+
+	wake_fd = eventfd(0, EFD_CLOEXEC);
+	if(wake_fd == ERROR)
+	{
+		syslog(LOG_ERR,"eventfd() failed\n");
+		#if DEBUG
+			printf("eventfd() failed\n");
+		#endif
+		return ERROR;
+	}
+	/*------------------------------------------------------------------------*/
+	sigfillset(&blocked);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	status = pthread_create(&writer_thread, NULL, storage_writer_thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	if(status != SUCCESS)
+	{
+		syslog(LOG_ERR,"pthread_create() failed with error code: %d\n",status);
+		#if DEBUG
+			printf("pthread_create() failed with error code: %d\n",status);
+		#endif
+		close(wake_fd);
+		wake_fd = ERROR;
+		return ERROR;
+	}
+	writer_running = true;
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+void storage_writer_stop(void)
+{
+	if(!writer_running)
+	{
+		return;
+	}
+
+	__atomic_store_n(&writer_stopping, true, __ATOMIC_SEQ_CST);
+	eventfd_write(wake_fd, 1);
+	pthread_join(writer_thread, NULL);
+	writer_running = false;
+
+	close(wake_fd);
+	wake_fd = ERROR;
+}
+/*------------------------------------------------------------------------*/
+static void* storage_writer_thread(void *arg)
+{
+	eventfd_t count;
+
+	stats_thread_register("writer");
+
+	while(true)
+	{
+		while(storage_writer_commit() > 0)
+		{
+		}
+
+		//announce the sleep, then look again so a push that missed the
+		//flag is not left behind
+		__atomic_store_n(&writer_idle, true, __ATOMIC_SEQ_CST);
+		if(!mpsc_queue_empty(&requests))
+		{
+			__atomic_store_n(&writer_idle, false, __ATOMIC_SEQ_CST);
+			continue;
+		}
+		if(__atomic_load_n(&writer_stopping, __ATOMIC_SEQ_CST))
+		{
+			break;
+		}
+		eventfd_read(wake_fd, &count);
+	}
+
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static int storage_writer_commit(void)
+{
+	static struct storage_request *batch[STORAGE_BATCH_MAX];
+	static struct iovec iov[STORAGE_BATCH_MAX];
+	static int notify[STORAGE_BATCH_MAX];
+	struct storage_request *request;
+	struct mpsc_node *node;
+	int count = 0, packets = 0, notified = 0, status, i, j;
+	uint64_t start;
+	size_t end;
+
+	while((count < STORAGE_BATCH_MAX) && ((node = mpsc_queue_pop(&requests)) != NULL))
+	{
+		request = mpsc_entry(node, struct storage_request, node);
+		batch[count++] = request;
+		if(request->length > 0)
+		{
+			iov[packets].iov_base 	= request->data;
+			iov[packets].iov_len 	= request->length;
+			packets++;
+		}
+	}
+	if(count == 0)
+	{
+		return 0;
+	}
+	/*------------------------------------------------------------------------*/
+	status = stats_mutex_lock(&mutex_lock);
+	if(status != SUCCESS)
+	{
+		async_log(LOG_ERR,"pthread_mutex_lock() failed with error code: %d\n",status);
+		#if DEBUG
+			printf("pthread_mutex_lock() failed with error code: %d\n",status);
+		#endif
+		status = ERROR;
+	}
+	else
+	{
+		end = storage_size();
+		start = stats_now();
+		status = (packets > 0) ? storage_append(iov, packets) : SUCCESS;
+		stats_record(STATS_APPEND, start);
+		stats_count(STATS_BATCHES, 1);
+
+		//a snapshot ends right after its own packet, as if every packet
+		//had been appended on its own
+		for(i = 0; i < count; i++)
+		{
+			request = batch[i];
+			end += request->length;
+			if(request->set_since)
+			{
+				*request->since = request->since_value;
+			}
+			if((status == SUCCESS) && (request->reply != NULL))
+			{
+				storage_snapshot(request->reply, (request->since != NULL) ? *request->since : 0, end);
+				if(request->since != NULL)
+				{
+					*request->since = request->reply->end;
+				}
+			}
+		}
+		stats_mutex_unlock(&mutex_lock);
+	}
+	/*------------------------------------------------------------------------*/
+	for(i = 0; i < count; i++)
+	{
+		request = batch[i];
+		request->status = status;
+		if(request->done_queue == NULL)
+		{
+			free(request);
+			continue;
+		}
+
+		//one wakeup per submitting loop and batch
+		for(j = 0; (j < notified) && (notify[j] != request->done_fd); j++)
+		{
+		}
+		if(j == notified)
+		{
+			notify[notified++] = request->done_fd;
+		}
+		mpsc_queue_push(request->done_queue, &request->node);
+	}
+	for(j = 0; j < notified; j++)
+	{
+		eventfd_write(notify[j], 1);
+	}
+
+	return count;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
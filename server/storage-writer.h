@@ -0,0 +1,101 @@
+/*
+ * @filename 		:	storage-writer.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Single thread owning all access to the storage
+ *						backend. Connection loops and the timestamp
+ *						thread submit requests through a lock-free MPSC
+ *						queue. The writer takes everything queued,
+ *						appends it with one writev() (group commit),
+ *						takes the reply snapshots and hands the requests
+ *						back, waking each submitting loop once per batch.
+ *						Write syscalls therefore scale with batches, not
+ *						packets.
+ */
+#ifndef STORAGE_WRITER_H_
+#define STORAGE_WRITER_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "mpsc-queue.h"
+#include "reply-engine.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define STORAGE_BATCH_MAX	(1024)		//requests per group commit, <= UIO_MAXIOV
+
+/*------------------------------------------------------------------------*/
+/*							REQUEST STRUCTURE							  */
+/*------------------------------------------------------------------------*/
+struct storage_request
+{
+	struct mpsc_node node;
+	struct mpsc_queue *done_queue;	//completed request goes here, NULL
+									//lets the writer free it
+	int done_fd;				//eventfd written after a batch completed
+	struct reply *reply;		//snapshot taken after the append, or NULL
+	size_t *since;				//incremental reply position, NULL for
+								//the full history, updated to the end of
+								//each snapshot
+	bool set_since;				//store since_value into *since first
+	size_t since_value;
+	void *context;				//owner of the request
+	int status;					//SUCCESS or ERROR once completed
+	size_t length;				//0 for requests that only snapshot
+	char data[];				//packet to append
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	allocates a request holding a copy of a packet, the
+ *					remaining fields are cleared (done_fd is -1)
+ *
+ * @parameters	:	data	:	packet to append, may be NULL if length is 0
+ *					length	:	size of the packet
+ *
+ * @returns		:	the request, NULL on failure
+ */
+struct storage_request* storage_request_alloc(const char *data, size_t length);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	queues a request for the writer. Requests of one
+ *					submitting thread are committed in submission order.
+ *
+ * @parameters	:	request	:	request to queue, owned by the writer
+ *								until it is handed back on done_queue
+ *
+ * @returns		:	none
+ */
+void storage_writer_submit(struct storage_request *request);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	starts the writer thread, the storage backend must be
+ *					open
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int storage_writer_start(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	commits everything queued so far and stops the
+ *					writer thread, nothing is done if it was never
+ *					started
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void storage_writer_stop(void);
+
+#endif /* STORAGE_WRITER_H_ */
+/*EOF*/
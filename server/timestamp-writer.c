@@ -0,0 +1,272 @@
+/*
+ * @filename 		:	timestamp-writer.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						timerfd driven timestamp thread.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <syslog.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+
+#include "aesdsocket.h"
+#include "storage-writer.h"
+#include "server-stats.h"
+#include "timestamp-writer.h"
+#include "async-log.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+#define TIMESTAMP_SIZE		(200)
+
+/*------------------------------------------------------------------------*/
+/*							GLOBAL VARIABLES							  */
+/*------------------------------------------------------------------------*/
+static pthread_t	writer_thread;
+static bool			writer_running	= false;
+static int			timer_fd		= ERROR;
+static int			stop_fd			= ERROR;	//eventfd waking the thread to exit
+static const char	*timestamp_format;
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	waits for timer expirations and appends a timestamp
+ *					for each of them until stop_fd is signalled
+ *
+ * @parameters	:	arg	:	unused
+ *
+ * @returns		:	NULL
+ */
+static void* timestamp_writer_thread(void *arg);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	formats the current local time and appends it to the
+ *					storage backend
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int timestamp_append(void);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	formats the current local time as a packet
+ *
+ * @parameters	:	timestr	:	TIMESTAMP_SIZE bytes for the packet
+ *
+ * @returns		:	length of the packet including its newline, 0 if
+ *					the format expands to nothing or past TIMESTAMP_SIZE
+ */
+static size_t timestamp_format_now(char *timestr);
+
+/*------------------------------------------------------------------------*/
+int timestamp_writer_start(unsigned int interval, const char *format)
+{
+	struct itimerspec timer;
+	sigset_t blocked, previous;
+	char timestr[TIMESTAMP_SIZE];
+	int status;
+
+	//a format that does not fit would fail every tick, refuse it up front
+	timestamp_format = format;
+	if(timestamp_format_now(timestr) == 0)
+	{
+		syslog(LOG_ERR,"timestamp format \"%s\" is empty or longer than %d bytes\n",
+				format, TIMESTAMP_SIZE - 2);
+		#if DEBUG
+			printf("timestamp format \"%s\" is empty or longer than %d bytes\n",
+					format, TIMESTAMP_SIZE - 2);
+		#endif
+		return ERROR;
+	}
+
+	timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if((timer_fd == ERROR) || (stop_fd == ERROR))
+	{
+		syslog(LOG_ERR,"timerfd_create()/eventfd() failed\n");
+		#if DEBUG
+			printf("timerfd_create()/eventfd() failed\n");
+		#endif
+		goto cleanup;
+	}
+	/*------------------------------------------------------------------------*/
+	memset(&timer, 0, sizeof(timer));
+	timer.it_interval.tv_sec 	= interval;
+	timer.it_value.tv_sec 		= interval;
+	if(timerfd_settime(timer_fd, 0, &timer, NULL) == ERROR)
+	{
+		syslog(LOG_ERR,"timerfd_settime() failed\n");
+		#if DEBUG
+			printf("timerfd_settime() failed\n");
+		#endif
+		goto cleanup;
+	}
+	/*------------------------------------------------------------------------*/
+	//process signals are left to the main thread
+	sigfillset(&blocked);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	status = pthread_create(&writer_thread, NULL, timestamp_writer_thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+	if(status != SUCCESS)
+	{
+		syslog(LOG_ERR,"pthread_create() failed with error code: %d\n",status);
+		#if DEBUG
+			printf("pthread_create() failed with error code: %d\n",status);
+		#endif
+		goto cleanup;
+	}
+	writer_running = true;
+
+	syslog(LOG_INFO,"Writing timestamps every %u s\n", interval);
+	return SUCCESS;
+
+cleanup:
+	if(timer_fd != ERROR)
+	{
+		close(timer_fd);
+		timer_fd = ERROR;
+	}
+	if(stop_fd != ERROR)
+	{
+		close(stop_fd);
+		stop_fd = ERROR;
+	}
+	return ERROR;
+}
+/*------------------------------------------------------------------------*/
+void timestamp_writer_stop(void)
+{
+	if(!writer_running)
+	{
+		return;
+	}
+
+	eventfd_write(stop_fd, 1);
+	pthread_join(writer_thread, NULL);
+	writer_running = false;
+
+	close(timer_fd);
+	close(stop_fd);
+	timer_fd = ERROR;
+	stop_fd = ERROR;
+}
+/*------------------------------------------------------------------------*/
+static void* timestamp_writer_thread(void *arg)
+{
+	struct pollfd fds[2];
+	uint64_t expirations;
+
+	stats_thread_register("timestamp");
+
+	fds[0].fd 		= timer_fd;
+	fds[0].events 	= POLLIN;
+	fds[1].fd 		= stop_fd;
+	fds[1].events 	= POLLIN;
+
+	while(true)
+	{
+		if(poll(fds, 2, -1) == ERROR)
+		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			async_log(LOG_ERR,"poll() failed\n");
+			#if DEBUG
+				printf("poll() failed\n");
+			#endif
+			break;
+		}
+		if(fds[1].revents & POLLIN)
+		{
+			break;
+		}
+		/*------------------------------------------------------------------------*/
+		//expirations missed while the lock was contended collapse into
+		//one timestamp, the history only needs the current time
+		if(read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+		{
+			continue;
+		}
+		//a failed tick is skipped, the next one is tried again
+		timestamp_append();
+	}
+
+	return NULL;
+}
+/*------------------------------------------------------------------------*/
+static int timestamp_append(void)
+{
+	char timestr[TIMESTAMP_SIZE];
+	struct storage_request *request;
+	size_t length;
+
+	length = timestamp_format_now(timestr);
+	if(length == 0)
+	{
+		async_log(LOG_ERR,"Could not format the timestamp\n");
+		#if DEBUG
+			printf("Could not format the timestamp\n");
+		#endif
+		return ERROR;
+	}
+	/*------------------------------------------------------------------------*/
+	//committed with the client packets, nobody waits for the result
+	request = storage_request_alloc(timestr, length);
+	if(request == NULL)
+	{
+		return ERROR;
+	}
+	storage_writer_submit(request);
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+static size_t timestamp_format_now(char *timestr)
+{
+	struct tm now;
+	time_t t;
+	size_t length;
+
+	t = time(NULL);
+	if(localtime_r(&t, &now) == NULL)
+	{
+		async_log(LOG_ERR,"localtime_r() failed\n");
+		#if DEBUG
+			printf("localtime_r() failed\n");
+		#endif
+		return 0;
+	}
+
+	//leave room for the newline that terminates the packet
+	length = strftime(timestr, TIMESTAMP_SIZE - 1, timestamp_format, &now);
+	if(length == 0)
+	{
+		return 0;
+	}
+	if(timestr[length - 1] != '\n')
+	{
+		timestr[length++] = '\n';
+	}
+	return length;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,44 @@
+/*
+ * @filename 		:	timestamp-writer.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Periodic timestamps for the storage history.
+ *						A dedicated thread waits on a timerfd and submits
+ *						each timestamp to the storage writer, exactly
+ *						like a client packet. No signal is raised, so no
+ *						I/O thread is interrupted.
+ */
+#ifndef TIMESTAMP_WRITER_H_
+#define TIMESTAMP_WRITER_H_
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	starts the timestamp thread. The first timestamp is
+ *					written one interval after the call.
+ *
+ * @parameters	:	interval	:	seconds between timestamps, > 0
+ *					format		:	strftime() format of a timestamp,
+ *									a newline is appended to close the
+ *									packet
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure or if format
+ *					expands to nothing or past 198 bytes
+ */
+int timestamp_writer_start(unsigned int interval, const char *format);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	stops and joins the timestamp thread, nothing is
+ *					done if it was never started
+ *
+ * @parameters	:	none
+ *
+ * @returns		:	none
+ */
+void timestamp_writer_stop(void);
+
+#endif /* TIMESTAMP_WRITER_H_ */
+/*EOF*/
@@ -0,0 +1,327 @@
+/*
+ * @filename 		:	uring.c
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Minimal io_uring wrapper on top of the raw
+ *						system calls.
+ */
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "aesdsocket.h"
+#include "uring.h"
+
+/*------------------------------------------------------------------------*/
+/*								MACROS									  */
+/*------------------------------------------------------------------------*/
+//flags tried first, DEFER_TASKRUN needs 6.1 and SINGLE_ISSUER 6.0
+#define URING_FAST_FLAGS	(IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN)
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	maps the rings of a freshly created instance
+ *
+ * @parameters	:	ring	:	ring to fill, ring->fd is set
+ *					params	:	parameters returned by io_uring_setup()
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+static int uring_map(struct uring *ring, struct io_uring_params *params);
+
+/*------------------------------------------------------------------------*/
+int uring_init(struct uring *ring, unsigned int entries)
+{
+	struct io_uring_params params;
+
+	memset(ring, 0, sizeof(struct uring));
+	ring->fd = ERROR;
+
+	memset(&params, 0, sizeof(params));
+	params.flags 		= URING_FAST_FLAGS | IORING_SETUP_R_DISABLED | IORING_SETUP_CQSIZE;
+	params.cq_entries 	= entries * 4;
+	ring->fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+	if((ring->fd == ERROR) && (errno == EINVAL))
+	{
+		//older kernel, any thread may submit
+		memset(&params, 0, sizeof(params));
+		params.flags 		= IORING_SETUP_CQSIZE;
+		params.cq_entries 	= entries * 4;
+		ring->fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+	}
+	if(ring->fd == ERROR)
+	{
+		syslog(LOG_ERR,"io_uring_setup() failed\n");
+		#if DEBUG
+			printf("io_uring_setup() failed\n");
+		#endif
+		return ERROR;
+	}
+	ring->disabled = (params.flags & IORING_SETUP_R_DISABLED) != 0;
+
+	if(uring_map(ring, &params) == ERROR)
+	{
+		uring_destroy(ring);
+		return ERROR;
+	}
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int uring_setup_buffers(struct uring *ring, unsigned int count, unsigned int size, unsigned short group)
+{
+	struct io_uring_buf_reg reg;
+	unsigned int i;
+
+	ring->buffers_size = count * sizeof(struct io_uring_buf);
+	ring->buffers = mmap(NULL, ring->buffers_size, PROT_READ | PROT_WRITE,
+							MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+	if(ring->buffers == MAP_FAILED)
+	{
+		ring->buffers = NULL;
+		syslog(LOG_ERR,"mmap() failed\n");
+		#if DEBUG
+			printf("mmap() failed\n");
+		#endif
+		return ERROR;
+	}
+
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr 		= (unsigned long) ring->buffers;
+	reg.ring_entries 	= count;
+	reg.bgid 			= group;
+	if(syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) == ERROR)
+	{
+		syslog(LOG_ERR,"io_uring_register() failed\n");
+		#if DEBUG
+			printf("io_uring_register() failed\n");
+		#endif
+		return ERROR;
+	}
+	/*------------------------------------------------------------------------*/
+	ring->buffer_memory = (char *) malloc((size_t) count * size);
+	if(ring->buffer_memory == NULL)
+	{
+		syslog(LOG_ERR,"malloc() failed\n");
+		#if DEBUG
+			printf("malloc() failed\n");
+		#endif
+		return ERROR;
+	}
+	ring->buffer_count 	= count;
+	ring->buffer_size 	= size;
+	ring->buffer_group 	= group;
+
+	for(i = 0; i < count; i++)
+	{
+		ring->buffers->bufs[i].addr = (unsigned long) uring_buffer(ring, i);
+		ring->buffers->bufs[i].len 	= size;
+		ring->buffers->bufs[i].bid 	= (unsigned short) i;
+	}
+	__atomic_store_n(&ring->buffers->tail, (unsigned short) count, __ATOMIC_RELEASE);
+
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+int uring_enable(struct uring *ring)
+{
+	if(!ring->disabled)
+	{
+		return SUCCESS;
+	}
+
+	if(syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_ENABLE_RINGS, NULL, 0) == ERROR)
+	{
+		syslog(LOG_ERR,"io_uring_register() failed\n");
+		#if DEBUG
+			printf("io_uring_register() failed\n");
+		#endif
+		return ERROR;
+	}
+	ring->disabled = false;
+	return SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+struct io_uring_sqe* uring_get_sqe(struct uring *ring)
+{
+	struct io_uring_sqe *sqe;
+	unsigned int index;
+
+	if((ring->sq_local_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE)) >= ring->sq_entries)
+	{
+		if((uring_submit(ring, 0) == ERROR) ||
+			((ring->sq_local_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE)) >= ring->sq_entries))
+		{
+			return NULL;
+		}
+	}
+
+	index = ring->sq_local_tail & ring->sq_mask;
+	sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	ring->sq_array[index] = index;
+	ring->sq_local_tail++;
+
+	return sqe;
+}
+/*------------------------------------------------------------------------*/
+int uring_submit(struct uring *ring, unsigned int wait)
+{
+	unsigned int pending;
+	int result;
+
+	__atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+	pending = ring->sq_local_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+	result = (int) syscall(__NR_io_uring_enter, ring->fd, pending, wait,
+							(wait > 0) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+	return (result == ERROR) ? ERROR : SUCCESS;
+}
+/*------------------------------------------------------------------------*/
+struct io_uring_cqe* uring_peek_cqe(struct uring *ring)
+{
+	unsigned int head = *ring->cq_head;
+
+	if(head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+	{
+		return NULL;
+	}
+	return &ring->cqes[head & ring->cq_mask];
+}
+/*------------------------------------------------------------------------*/
+void uring_cqe_seen(struct uring *ring)
+{
+	__atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+/*------------------------------------------------------------------------*/
+char* uring_buffer(struct uring *ring, unsigned int id)
+{
+	return ring->buffer_memory + ((size_t) id * ring->buffer_size);
+}
+/*------------------------------------------------------------------------*/
+void uring_buffer_recycle(struct uring *ring, unsigned int id)
+{
+	unsigned short tail = ring->buffers->tail;
+	struct io_uring_buf *buf = &ring->buffers->bufs[tail & (ring->buffer_count - 1)];
+
+	buf->addr 	= (unsigned long) uring_buffer(ring, id);
+	buf->len 	= ring->buffer_size;
+	buf->bid 	= (unsigned short) id;
+	__atomic_store_n(&ring->buffers->tail, (unsigned short) (tail + 1), __ATOMIC_RELEASE);
+}
+/*------------------------------------------------------------------------*/
+void uring_destroy(struct uring *ring)
+{
+	if(ring->fd != ERROR)
+	{
+		close(ring->fd);
+		ring->fd = ERROR;
+	}
+	if(ring->sqes != NULL)
+	{
+		munmap(ring->sqes, ring->sqes_size);
+	}
+	if((ring->cq_ring != NULL) && (ring->cq_ring != ring->sq_ring))
+	{
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	}
+	if(ring->sq_ring != NULL)
+	{
+		munmap(ring->sq_ring, ring->sq_ring_size);
+	}
+	if(ring->buffers != NULL)
+	{
+		munmap(ring->buffers, ring->buffers_size);
+	}
+	free(ring->buffer_memory);
+	memset(ring, 0, sizeof(struct uring));
+	ring->fd = ERROR;
+}
+/*------------------------------------------------------------------------*/
+static int uring_map(struct uring *ring, struct io_uring_params *params)
+{
+	char *sq, *cq;
+
+	ring->sq_ring_size = params->sq_off.array + params->sq_entries * sizeof(unsigned int);
+	ring->cq_ring_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+	if(params->features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if(ring->cq_ring_size > ring->sq_ring_size)
+		{
+			ring->sq_ring_size = ring->cq_ring_size;
+		}
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+
+	ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+							MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if(ring->sq_ring == MAP_FAILED)
+	{
+		ring->sq_ring = NULL;
+		syslog(LOG_ERR,"mmap() failed\n");
+		#if DEBUG
+			printf("mmap() failed\n");
+		#endif
+		return ERROR;
+	}
+	if(params->features & IORING_FEAT_SINGLE_MMAP)
+	{
+		ring->cq_ring = ring->sq_ring;
+	}
+	else
+	{
+		ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+								MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+		if(ring->cq_ring == MAP_FAILED)
+		{
+			ring->cq_ring = NULL;
+			syslog(LOG_ERR,"mmap() failed\n");
+			#if DEBUG
+				printf("mmap() failed\n");
+			#endif
+			return ERROR;
+		}
+	}
+
+	ring->sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+						MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if(ring->sqes == MAP_FAILED)
+	{
+		ring->sqes = NULL;
+		syslog(LOG_ERR,"mmap() failed\n");
+		#if DEBUG
+			printf("mmap() failed\n");
+		#endif
+		return ERROR;
+	}
+	/*------------------------------------------------------------------------*/
+	sq = (char *) ring->sq_ring;
+	ring->sq_head 		= (unsigned int *) (sq + params->sq_off.head);
+	ring->sq_tail 		= (unsigned int *) (sq + params->sq_off.tail);
+	ring->sq_array 		= (unsigned int *) (sq + params->sq_off.array);
+	ring->sq_mask 		= *(unsigned int *) (sq + params->sq_off.ring_mask);
+	ring->sq_entries 	= params->sq_entries;
+	ring->sq_local_tail = *ring->sq_tail;
+
+	cq = (char *) ring->cq_ring;
+	ring->cq_head 		= (unsigned int *) (cq + params->cq_off.head);
+	ring->cq_tail 		= (unsigned int *) (cq + params->cq_off.tail);
+	ring->cq_mask 		= *(unsigned int *) (cq + params->cq_off.ring_mask);
+	ring->cqes 			= (struct io_uring_cqe *) (cq + params->cq_off.cqes);
+
+	return SUCCESS;
+}
+/*EOF*/
+/*------------------------------------------------------------------------*/
@@ -0,0 +1,175 @@
+/*
+ * @filename 		:	uring.h
+ *
+ * @author			: 	Tanmay Mahendra Kothale (tanmay-mk)
+ *
+ * @date 			:	Oct 17, 2026
+ *						Minimal io_uring wrapper on top of the raw
+ *						system calls (liburing is not a dependency of
+ *						aesdsocket). Maps the submission and completion
+ *						rings of one instance and registers a ring of
+ *						provided receive buffers that the kernel picks
+ *						from for buffer select / multishot receives.
+ *
+ *						A struct uring is used by a single thread, the
+ *						one that called uring_enable().
+ */
+#ifndef URING_H_
+#define URING_H_
+/*------------------------------------------------------------------------*/
+/*								LIBRARY FILES							  */
+/*------------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+#include <linux/io_uring.h>
+
+/*------------------------------------------------------------------------*/
+/*							URING STRUCTURE								  */
+/*------------------------------------------------------------------------*/
+struct uring
+{
+	int fd;					//io_uring instance, -1 if unused
+	bool disabled;			//created with IORING_SETUP_R_DISABLED
+
+	//submission ring
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_array;
+	unsigned int sq_mask;
+	unsigned int sq_entries;
+	unsigned int sq_local_tail;	//sqes handed out, published by uring_submit()
+	struct io_uring_sqe *sqes;
+
+	//completion ring
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int cq_mask;
+	struct io_uring_cqe *cqes;
+
+	void *sq_ring;
+	size_t sq_ring_size;
+	void *cq_ring;			//same mapping as sq_ring with IORING_FEAT_SINGLE_MMAP
+	size_t cq_ring_size;
+	size_t sqes_size;
+
+	//provided receive buffers
+	struct io_uring_buf_ring *buffers;
+	size_t buffers_size;
+	char *buffer_memory;
+	unsigned int buffer_count;	//power of two
+	unsigned int buffer_size;
+	unsigned short buffer_group;
+};
+
+/*------------------------------------------------------------------------*/
+/* 							FUNCTION PROTOTYPES	 						  */
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	creates an io_uring instance and maps its rings. The
+ *					ring starts disabled so that the thread calling
+ *					uring_enable() becomes its single issuer.
+ *
+ * @parameters	:	ring	:	ring to initialize
+ *					entries	:	submission queue entries, the completion
+ *								queue gets four times as many
+ *
+ * @returns		:	SUCCESS on success, ERROR if io_uring is unavailable
+ */
+int uring_init(struct uring *ring, unsigned int entries);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	registers count provided buffers of size bytes as
+ *					buffer group group and hands all of them to the
+ *					kernel. Needs a 5.19 or later kernel.
+ *
+ * @parameters	:	ring	:	ring to register with
+ *					count	:	number of buffers, a power of two
+ *					size	:	size of each buffer
+ *					group	:	buffer group id used in sqe->buf_group
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int uring_setup_buffers(struct uring *ring, unsigned int count, unsigned int size, unsigned short group);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	enables a ring created disabled, binding it to the
+ *					calling thread
+ *
+ * @parameters	:	ring	:	ring to enable
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure
+ */
+int uring_enable(struct uring *ring);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	returns a zeroed submission queue entry, submitting
+ *					the queued ones first if the queue is full
+ *
+ * @parameters	:	ring	:	ring to take the entry from
+ *
+ * @returns		:	the entry, NULL if the queue stays full
+ */
+struct io_uring_sqe* uring_get_sqe(struct uring *ring);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	submits every queued entry with a single
+ *					io_uring_enter() and waits for completions
+ *
+ * @parameters	:	ring	:	ring to submit
+ *					wait	:	completions to wait for, 0 to not block
+ *
+ * @returns		:	SUCCESS on success, ERROR on failure (errno is set)
+ */
+int uring_submit(struct uring *ring, unsigned int wait);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	returns the oldest completion without consuming it
+ *
+ * @parameters	:	ring	:	ring to look at
+ *
+ * @returns		:	the completion, NULL if there is none
+ */
+struct io_uring_cqe* uring_peek_cqe(struct uring *ring);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	consumes the completion returned by uring_peek_cqe()
+ *
+ * @parameters	:	ring	:	ring the completion belongs to
+ *
+ * @returns		:	none
+ */
+void uring_cqe_seen(struct uring *ring);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	returns the provided buffer a completion was
+ *					received into
+ *
+ * @parameters	:	ring	:	ring owning the buffers
+ *					id		:	buffer id, cqe->flags >> IORING_CQE_BUFFER_SHIFT
+ *
+ * @returns		:	start of the buffer
+ */
+char* uring_buffer(struct uring *ring, unsigned int id);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	hands a consumed buffer back to the kernel
+ *
+ * @parameters	:	ring	:	ring owning the buffers
+ *					id		:	buffer id
+ *
+ * @returns		:	none
+ */
+void uring_buffer_recycle(struct uring *ring, unsigned int id);
+/*------------------------------------------------------------------------*/
+/*
+ * @brief		: 	closes the instance, which cancels everything still
+ *					pending, and unmaps the rings and buffers
+ *
+ * @parameters	:	ring	:	ring to destroy
+ *
+ * @returns		:	none
+ */
+void uring_destroy(struct uring *ring);
+
+#endif /* URING_H_ */
+/*EOF*/